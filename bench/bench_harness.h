@@ -0,0 +1,368 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <regex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * 内置的简易基准框架 - 没有安装Google Benchmark时使用
+ * 只实现pattern_bench用到的那部分接口（State、BENCHMARK、Arg/Args/Range/Apply、Unit），
+ * 基准代码两种情况下写法完全一样。
+ * 输出的JSON与Google Benchmark的格式兼容（context + benchmarks），可以直接用同一套工具对比。
+ * 支持的命令行参数：--benchmark_filter=<正则> --benchmark_min_time=<秒>
+ *                   --benchmark_format=<console|json> --benchmark_out=<文件>
+ */
+namespace benchmark {
+
+class Runner;
+
+enum TimeUnit { kNanosecond, kMicrosecond, kMillisecond, kSecond };
+
+inline const char* timeUnitName(TimeUnit unit) {
+    switch (unit) {
+        case kMicrosecond: return "us";
+        case kMillisecond: return "ms";
+        case kSecond: return "s";
+        default: return "ns";
+    }
+}
+
+inline double timeUnitMultiplier(TimeUnit unit) {
+    switch (unit) {
+        case kMicrosecond: return 1e6;
+        case kMillisecond: return 1e3;
+        case kSecond: return 1.0;
+        default: return 1e9;
+    }
+}
+
+template<typename T>
+inline void DoNotOptimize(T&& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+inline void ClobberMemory() {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#endif
+}
+
+class State {
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    std::vector<int64_t> arguments;
+    uint64_t maxIterations;
+    Clock::time_point realStart;
+    std::clock_t cpuStart = 0;
+    double realSeconds = 0.0;
+    double cpuSeconds = 0.0;
+    bool running = false;
+    int64_t itemsProcessed = 0;
+    
+    friend class Runner;
+
+public:
+    struct [[maybe_unused]] Value {};
+    
+    class Iterator {
+    private:
+        State* state;
+        uint64_t remaining;
+    
+    public:
+        Iterator(State* owner, uint64_t count) : state(owner), remaining(count) {}
+        Value operator*() const { return Value(); }
+        Iterator& operator++() {
+            --remaining;
+            return *this;
+        }
+        bool operator!=(const Iterator&) const {
+            if (remaining != 0) {
+                return true;
+            }
+            state->PauseTiming();
+            return false;
+        }
+    };
+    
+    State(std::vector<int64_t> args, uint64_t iterations)
+        : arguments(std::move(args)), maxIterations(iterations) {}
+    
+    Iterator begin() {
+        ResumeTiming();
+        return Iterator(this, maxIterations);
+    }
+    Iterator end() { return Iterator(this, 0); }
+    
+    void PauseTiming() {
+        if (running) {
+            realSeconds += std::chrono::duration<double>(Clock::now() - realStart).count();
+            cpuSeconds += static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+            running = false;
+        }
+    }
+    
+    void ResumeTiming() {
+        if (!running) {
+            cpuStart = std::clock();
+            realStart = Clock::now();
+            running = true;
+        }
+    }
+    
+    int64_t range(size_t index = 0) const { return arguments[index]; }
+    uint64_t iterations() const { return maxIterations; }
+    void SetItemsProcessed(int64_t items) { itemsProcessed = items; }
+};
+
+namespace internal {
+
+class Benchmark {
+private:
+    std::string name;
+    std::function<void(State&)> function;
+    std::vector<std::vector<int64_t>> argumentSets;
+    int rangeMultiplier = 8;
+    TimeUnit unit = kNanosecond;
+    
+    friend class ::benchmark::Runner;
+
+public:
+    Benchmark(std::string benchmarkName, std::function<void(State&)> benchmarkFunction)
+        : name(std::move(benchmarkName)), function(std::move(benchmarkFunction)) {}
+    
+    Benchmark* Arg(int64_t value) {
+        argumentSets.push_back({value});
+        return this;
+    }
+    
+    Benchmark* Args(const std::vector<int64_t>& values) {
+        argumentSets.push_back(values);
+        return this;
+    }
+    
+    Benchmark* RangeMultiplier(int multiplier) {
+        rangeMultiplier = std::max(2, multiplier);
+        return this;
+    }
+    
+    // 与Google Benchmark一致：start、各个multiplier的幂以及limit
+    Benchmark* Range(int64_t start, int64_t limit) {
+        for (int64_t value = start; value < limit; value *= rangeMultiplier) {
+            Arg(value);
+            if (value == 0) {
+                break;
+            }
+        }
+        return Arg(limit);
+    }
+    
+    Benchmark* Apply(void (*customize)(Benchmark*)) {
+        customize(this);
+        return this;
+    }
+    
+    Benchmark* Unit(TimeUnit timeUnit) {
+        unit = timeUnit;
+        return this;
+    }
+};
+
+} // namespace internal
+
+class Runner {
+private:
+    using Benchmark = internal::Benchmark;
+    
+    struct Result {
+        std::string name;
+        uint64_t iterations;
+        double realTime;
+        double cpuTime;
+        TimeUnit unit;
+        double itemsPerSecond;
+    };
+    
+    static std::vector<std::unique_ptr<Benchmark>>& registry() {
+        static std::vector<std::unique_ptr<Benchmark>> benchmarks;
+        return benchmarks;
+    }
+    
+    static std::string fullName(const Benchmark& benchmark, const std::vector<int64_t>& args) {
+        std::string result = benchmark.name;
+        for (int64_t arg : args) {
+            result += "/" + std::to_string(arg);
+        }
+        return result;
+    }
+    
+    // 与Google Benchmark相同的策略：迭代次数逐步放大，直到总时间超过min_time
+    static Result run(const Benchmark& benchmark, const std::vector<int64_t>& args, double minTime) {
+        uint64_t iterations = 1;
+        for (;;) {
+            State state(args, iterations);
+            benchmark.function(state);
+            state.PauseTiming();
+            bool enough = state.realSeconds >= minTime || iterations >= 1000000000ull;
+            if (enough) {
+                double multiplier = timeUnitMultiplier(benchmark.unit);
+                double seconds = state.realSeconds > 0.0 ? state.realSeconds : 1e-12;
+                return {fullName(benchmark, args), iterations,
+                        state.realSeconds * multiplier / iterations,
+                        state.cpuSeconds * multiplier / iterations,
+                        benchmark.unit,
+                        state.itemsProcessed ? state.itemsProcessed / seconds : 0.0};
+            }
+            double growth = state.realSeconds > 0.0 ? minTime * 1.4 / state.realSeconds : 10.0;
+            growth = std::min(10.0, std::max(growth, 1.4));
+            iterations = std::max(iterations + 1, static_cast<uint64_t>(iterations * growth));
+        }
+    }
+    
+    static std::string escape(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+            }
+            out += c;
+        }
+        return out;
+    }
+    
+    static void writeJson(std::FILE* out, const std::vector<Result>& results, const char* executable) {
+        char date[64];
+        std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+        std::fprintf(out, "{\n  \"context\": {\n");
+        std::fprintf(out, "    \"date\": \"%s\",\n", date);
+        std::fprintf(out, "    \"executable\": \"%s\",\n", escape(executable).c_str());
+        std::fprintf(out, "    \"num_cpus\": %u,\n", std::thread::hardware_concurrency());
+#ifdef NDEBUG
+        std::fprintf(out, "    \"library_build_type\": \"release\",\n");
+#else
+        std::fprintf(out, "    \"library_build_type\": \"debug\",\n");
+#endif
+        std::fprintf(out, "    \"harness\": \"pattern_bench builtin\"\n  },\n  \"benchmarks\": [\n");
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            std::fprintf(out, "    {\n      \"name\": \"%s\",\n      \"run_name\": \"%s\",\n"
+                              "      \"run_type\": \"iteration\",\n      \"iterations\": %llu,\n"
+                              "      \"real_time\": %.6e,\n      \"cpu_time\": %.6e,\n      \"time_unit\": \"%s\"",
+                         escape(r.name).c_str(), escape(r.name).c_str(),
+                         static_cast<unsigned long long>(r.iterations), r.realTime, r.cpuTime,
+                         timeUnitName(r.unit));
+            if (r.itemsPerSecond > 0.0) {
+                std::fprintf(out, ",\n      \"items_per_second\": %.6e", r.itemsPerSecond);
+            }
+            std::fprintf(out, "\n    }%s\n", i + 1 < results.size() ? "," : "");
+        }
+        std::fprintf(out, "  ]\n}\n");
+    }
+    
+    static void writeConsoleLine(const Result& r) {
+        std::printf("%-48s %14.1f %-2s %14.1f %-2s %12llu", r.name.c_str(), r.realTime, timeUnitName(r.unit),
+                    r.cpuTime, timeUnitName(r.unit), static_cast<unsigned long long>(r.iterations));
+        if (r.itemsPerSecond > 0.0) {
+            std::printf("  items/s=%.4g", r.itemsPerSecond);
+        }
+        std::printf("\n");
+        std::fflush(stdout);
+    }
+    
+    static bool readFlag(const char* arg, const char* flag, std::string& value) {
+        size_t length = std::strlen(flag);
+        if (std::strncmp(arg, flag, length) == 0 && arg[length] == '=') {
+            value = arg + length + 1;
+            return true;
+        }
+        return false;
+    }
+
+public:
+    static Benchmark* add(const char* name, void (*function)(State&)) {
+        registry().push_back(std::make_unique<Benchmark>(name, function));
+        return registry().back().get();
+    }
+    
+    static int runAll(int argc, char** argv) {
+        std::string filter = ".", format = "console", outPath, value;
+        double minTime = 0.5;
+        for (int i = 1; i < argc; ++i) {
+            if (readFlag(argv[i], "--benchmark_filter", value)) {
+                filter = value;
+            } else if (readFlag(argv[i], "--benchmark_format", value)) {
+                format = value;
+            } else if (readFlag(argv[i], "--benchmark_out", value)) {
+                outPath = value;
+            } else if (readFlag(argv[i], "--benchmark_min_time", value)) {
+                minTime = std::atof(value.c_str());   // 接受"0.5"和"0.5s"
+            } else if (readFlag(argv[i], "--benchmark_out_format", value)) {
+                // 输出文件总是JSON
+            } else {
+                std::fprintf(stderr, "未知参数: %s\n", argv[i]);
+                return 1;
+            }
+        }
+    
+        std::regex pattern(filter);
+        std::vector<Result> results;
+        bool console = format != "json";
+        if (console) {
+            std::printf("%-48s %17s %17s %12s\n", "Benchmark", "Time", "CPU", "Iterations");
+        }
+        for (const auto& benchmark : registry()) {
+            std::vector<std::vector<int64_t>> argumentSets = benchmark->argumentSets;
+            if (argumentSets.empty()) {
+                argumentSets.emplace_back();
+            }
+            for (const auto& args : argumentSets) {
+                if (!std::regex_search(fullName(*benchmark, args), pattern)) {
+                    continue;
+                }
+                results.push_back(run(*benchmark, args, minTime));
+                if (console) {
+                    writeConsoleLine(results.back());
+                }
+            }
+        }
+        if (!console) {
+            writeJson(stdout, results, argv[0]);
+        }
+        if (!outPath.empty()) {
+            std::FILE* out = std::fopen(outPath.c_str(), "w");
+            if (!out) {
+                std::fprintf(stderr, "无法写入: %s\n", outPath.c_str());
+                return 1;
+            }
+            writeJson(out, results, argv[0]);
+            std::fclose(out);
+        }
+        return 0;
+    }
+};
+
+} // namespace benchmark
+
+#define BENCHMARK_PRIVATE_CONCAT2(a, b) a##b
+#define BENCHMARK_PRIVATE_CONCAT(a, b) BENCHMARK_PRIVATE_CONCAT2(a, b)
+#define BENCHMARK(function) \
+    static ::benchmark::internal::Benchmark* BENCHMARK_PRIVATE_CONCAT(benchmarkRegistration, __LINE__) = \
+        ::benchmark::Runner::add(#function, function)
+#define BENCHMARK_MAIN() \
+    int main(int argc, char** argv) { return ::benchmark::Runner::runAll(argc, argv); }
@@ -0,0 +1,214 @@
+#ifdef PATTERN_BENCH_USE_GOOGLE_BENCHMARK
+#include <benchmark/benchmark.h>
+#else
+#include "bench_harness.h"
+#endif
+
+#include "structural/flyweight.h"
+#include "behavioral/chain_of_responsibility.h"
+#include "behavioral/observer.h"
+#include "behavioral/command.h"
+#include "behavioral/state.h"
+#include "behavioral/strategy.h"
+#include "creational/prototype.h"
+
+#include <cmath>
+
+/**
+ * 性能基准 - 热点路径的微基准，参数为实体数量
+ * 运行：pattern_bench --benchmark_format=json --benchmark_out=result.json
+ * 找到Google Benchmark时链接它，否则使用bench_harness.h中的简易框架，JSON格式相同
+ */
+
+// 实体数量参数：100 ~ 100000，按10倍递增
+static void entityCounts(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(10)->Range(100, 100000);
+}
+
+// 实体数量 x 模式开关
+static void entityCountsWithMode(benchmark::internal::Benchmark* b) {
+    for (int64_t count = 100; count <= 100000; count *= 10) {
+        b->Args({count, 0});
+        b->Args({count, 1});
+    }
+}
+
+// 享元：粒子积分和剔除，粒子少于九成时在计时外补齐
+static void BM_ParticleSystemUpdate(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    ParticleSystem particles("bench_particle", count);
+    for (auto _ : state) {
+        if (particles.getParticleCount() < count * 9 / 10) {
+            state.PauseTiming();
+            while (particles.getParticleCount() < count && particles.emitParticle(960.0f, 540.0f)) {
+            }
+            state.ResumeTiming();
+        }
+        particles.update(0.001f);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * count));
+}
+BENCHMARK(BM_ParticleSystemUpdate)->Apply(entityCounts);
+
+// 享元：整张地图都在视口内，参数为瓦片总数
+static void BM_TileMapRender(benchmark::State& state) {
+    const int side = std::max(1, static_cast<int>(std::sqrt(static_cast<double>(state.range(0)))));
+    const int tileSize = 32;
+    TileMap map(side, side, tileSize);
+    const char* textures[] = {"grass", "stone", "water", "sand"};
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            map.setTile(x, y, textures[(x + y) % 4]);
+        }
+    }
+    map.setViewportSize(static_cast<float>(side * tileSize), static_cast<float>(side * tileSize));
+    for (auto _ : state) {
+        map.render(0.0f, 0.0f);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * side * side);
+}
+BENCHMARK(BM_TileMapRender)->Apply(entityCounts);
+
+// 责任链：每次处理range(0)个事件，range(1)为1时使用编译分发表
+static void BM_EventManagerProcessEvents(benchmark::State& state) {
+    const int64_t count = state.range(0);
+    EventManager manager;
+    manager.setCompiledDispatch(state.range(1) != 0);
+    const uint32_t physical = EventStringTable::getInstance().intern("物理");
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (int64_t i = 0; i < count; ++i) {
+            if (i % 4 == 0) {
+                manager.emplaceEvent<InputEvent>(static_cast<int>(i % 128), true);
+            } else {
+                manager.emplaceEvent<DamageEvent>(static_cast<int>(i % 50), physical, "goblin");
+            }
+        }
+        state.ResumeTiming();
+        manager.processEvents();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * count);
+}
+BENCHMARK(BM_EventManagerProcessEvents)->Apply(entityCountsWithMode);
+
+// 观察者：一个主题通知range(0)个观察者
+class BenchObserver : public Observer {
+public:
+    uint64_t notifications = 0;
+    
+    void update(Subject*) override { ++notifications; }
+    std::string getObserverName() const override { return "bench"; }
+};
+
+static void BM_SubjectNotifyFanout(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    Subject subject;
+    std::vector<BenchObserver> observers(count);
+    for (auto& observer : observers) {
+        subject.attach(&observer);
+    }
+    subject.synchronize();
+    for (auto _ : state) {
+        subject.notify();
+    }
+    benchmark::DoNotOptimize(observers.front().notifications);
+    for (auto& observer : observers) {
+        subject.detach(&observer);
+    }
+    subject.synchronize();
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * count));
+}
+BENCHMARK(BM_SubjectNotifyFanout)->Apply(entityCounts);
+
+// 命令：历史已满时每条新命令都会淘汰最旧的一条，参数为历史上限
+static void BM_CommandManagerExecuteAtCap(benchmark::State& state) {
+    const size_t cap = static_cast<size_t>(state.range(0));
+    CommandManager manager(cap);
+    GameCharacter hero("hero");
+    for (size_t i = 0; i < cap; ++i) {
+        manager.executeCommand(std::make_unique<MoveCommand>(&hero, 1.0f, 0.0f));
+    }
+    for (auto _ : state) {
+        manager.executeCommand(std::make_unique<MoveCommand>(&hero, 1.0f, 0.0f));
+    }
+    benchmark::DoNotOptimize(hero.getX());
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_CommandManagerExecuteAtCap)->Apply(entityCounts);
+
+// 状态：range(0)个角色在空闲和行走之间来回切换
+static void BM_StateCharacterSetState(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    std::vector<std::unique_ptr<StateCharacter>> characters;
+    characters.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        characters.push_back(std::make_unique<StateCharacter>("npc"));
+    }
+    bool walking = false;
+    for (auto _ : state) {
+        walking = !walking;
+        StateId next = walking ? StateId::Walking : StateId::Idle;
+        for (auto& character : characters) {
+            character->setState(next);
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * count));
+}
+BENCHMARK(BM_StateCharacterSetState)->Apply(entityCounts);
+
+// 策略：range(0)个敌人更新一帧，range(1)为1时使用JobSystem并行更新
+static void BM_BattleManagerUpdate(benchmark::State& state) {
+    const int count = static_cast<int>(state.range(0));
+    BattleManager battle;
+    battle.createEnemies(count);
+    battle.setPlayerPosition(count * 25.0f, 0.0f);
+    std::unique_ptr<JobSystem> jobs;
+    if (state.range(1) != 0) {
+        jobs = std::make_unique<JobSystem>();
+    }
+    for (auto _ : state) {
+        if (jobs) {
+            battle.updateBattle(0.016f, *jobs);
+        } else {
+            battle.updateBattle(0.016f);
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * count);
+}
+BENCHMARK(BM_BattleManagerUpdate)->Apply(entityCountsWithMode)->Unit(benchmark::kMicrosecond);
+
+// 原型：每次迭代克隆range(0)个对象，range(1)为0按名字查找，为1按类型ID查找
+static void BM_PrototypeManagerCreateObject(benchmark::State& state) {
+    const int64_t count = state.range(0);
+    const bool byId = state.range(1) != 0;
+    PrototypeManager manager;
+    manager.registerPrototype(std::make_unique<Bullet>());
+    manager.registerPrototype(std::make_unique<EnemyUnit>());
+    const std::string names[] = {"Bullet", "Enemy"};
+    const GameObjectType ids[] = {GameObjectType::Bullet, GameObjectType::Enemy};
+    for (auto _ : state) {
+        for (int64_t i = 0; i < count; ++i) {
+            auto object = byId ? manager.createObject(ids[i & 1]) : manager.createObject(names[i & 1]);
+            benchmark::DoNotOptimize(object.get());
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * count);
+}
+BENCHMARK(BM_PrototypeManagerCreateObject)->Apply(entityCountsWithMode);
+
+// 对象池：生成range(0)颗子弹再全部回收，与上面的逐个克隆对比
+static void BM_GameObjectPoolSpawnBullets(benchmark::State& state) {
+    const int64_t count = state.range(0);
+    GameObjectPool pool(static_cast<size_t>(count));
+    for (auto _ : state) {
+        for (int64_t i = 0; i < count; ++i) {
+            benchmark::DoNotOptimize(pool.spawnBullet(static_cast<float>(i), 0.0f));
+        }
+        pool.getBulletPool().releaseAll();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * count);
+}
+BENCHMARK(BM_GameObjectPoolSpawnBullets)->Apply(entityCounts);
+
+BENCHMARK_MAIN();
@@ -2,6 +2,20 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <thread>
+#include <string_view>
+#include <cstring>
+#include "structural/profiler.h"
 
 /**
  * 责任链模式 (Chain of Responsibility Pattern)
@@ -9,6 +23,79 @@
  * 特点：将请求的发送者和接收者解耦，让多个对象都有机会处理请求
  */
 
+// 事件字符串表 - 把伤害类型等取值有限的字符串驻留为32位ID
+// 驻留时加锁；按ID取字符串是无锁的分页数组下标访问，返回的引用永久有效。
+// 表只增不减，不要驻留实体ID这类取值无限增长的字符串
+class EventStringTable {
+public:
+    static constexpr uint32_t PAGE_SIZE = 1024;
+    static constexpr uint32_t MAX_PAGES = 1024;
+    
+private:
+    struct Page {
+        std::string strings[PAGE_SIZE];
+    };
+    
+    std::atomic<Page*> pages[MAX_PAGES];
+    std::atomic<uint32_t> count;
+    std::mutex mutex;
+    std::unordered_map<std::string, uint32_t> ids;
+    
+    EventStringTable() : count(0) {
+        for (auto& page : pages) {
+            page.store(nullptr, std::memory_order_relaxed);
+        }
+        intern("");  // 0号为空字符串
+    }
+    
+public:
+    EventStringTable(const EventStringTable&) = delete;
+    EventStringTable& operator=(const EventStringTable&) = delete;
+    
+    ~EventStringTable() {
+        for (auto& page : pages) {
+            delete page.load(std::memory_order_relaxed);
+        }
+    }
+    
+    static EventStringTable& getInstance() {
+        static EventStringTable instance;
+        return instance;
+    }
+    
+    uint32_t intern(const std::string& str) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = ids.find(str);
+        if (it != ids.end()) {
+            return it->second;
+        }
+        
+        uint32_t id = count.load(std::memory_order_relaxed);
+        if (id >= PAGE_SIZE * MAX_PAGES) {
+            throw std::length_error("事件字符串表已满");
+        }
+        Page* page = pages[id / PAGE_SIZE].load(std::memory_order_relaxed);
+        if (!page) {
+            page = new Page();
+            pages[id / PAGE_SIZE].store(page, std::memory_order_release);
+        }
+        page->strings[id % PAGE_SIZE] = str;
+        ids.emplace(str, id);
+        count.store(id + 1, std::memory_order_release);  // 发布新字符串
+        return id;
+    }
+    
+    // 无效ID返回空字符串
+    const std::string& lookup(uint32_t id) const {
+        if (id >= count.load(std::memory_order_acquire)) {
+            id = 0;
+        }
+        return pages[id / PAGE_SIZE].load(std::memory_order_acquire)->strings[id % PAGE_SIZE];
+    }
+    
+    size_t size() const { return count.load(std::memory_order_acquire); }
+};
+
 // 请求基类 - 游戏事件
 class GameEvent {
 public:
@@ -17,7 +104,8 @@ public:
         COLLISION_EVENT,
         DAMAGE_EVENT,
         UI_EVENT,
-        AUDIO_EVENT
+        AUDIO_EVENT,
+        EVENT_TYPE_COUNT  // 类型数量，用于按类型建表
     };
     
 protected:
@@ -48,20 +136,224 @@ public:
 };
 
 // 具体请求 - 伤害事件
+// 伤害类型只保存驻留后的ID；目标ID取值无限增长，不进字符串表，
+// 而是定长内联保存（超长时在UTF-8字符边界截断），构造事件不分配内存
 class DamageEvent : public GameEvent {
+public:
+    static constexpr size_t TARGET_CAPACITY = 24;   // 含结尾的'\0'
+    
 private:
     int damage;
-    std::string damageType;
-    std::string targetId;
+    uint32_t damageTypeKey;
+    uint8_t targetLength;
+    char target[TARGET_CAPACITY];
+    
+    void setTarget(std::string_view id) {
+        size_t length = std::min(id.size(), TARGET_CAPACITY - 1);
+        if (length < id.size()) {
+            while (length > 0 && (static_cast<unsigned char>(id[length]) & 0xC0) == 0x80) {
+                --length;   // 不截断在多字节字符中间
+            }
+        }
+        std::memcpy(target, id.data(), length);
+        target[length] = '\0';
+        targetLength = static_cast<uint8_t>(length);
+    }
     
 public:
-    DamageEvent(int dmg, const std::string& type, const std::string& target)
-        : GameEvent(DAMAGE_EVENT), damage(dmg), damageType(type), targetId(target) {}
+    DamageEvent(int dmg, const std::string& type, const std::string& targetId)
+        : GameEvent(DAMAGE_EVENT), damage(dmg),
+          damageTypeKey(EventStringTable::getInstance().intern(type)) {
+        setTarget(targetId);
+    }
+    
+    // 使用预先驻留的伤害类型ID构造（热路径）
+    DamageEvent(int dmg, uint32_t typeKey, std::string_view targetId)
+        : GameEvent(DAMAGE_EVENT), damage(dmg), damageTypeKey(typeKey) {
+        setTarget(targetId);
+    }
     
     int getDamage() const { return damage; }
     void setDamage(int dmg) { damage = dmg; }
-    const std::string& getDamageType() const { return damageType; }
-    const std::string& getTargetId() const { return targetId; }
+    const std::string& getDamageType() const { return EventStringTable::getInstance().lookup(damageTypeKey); }
+    std::string_view getTargetId() const { return std::string_view(target, targetLength); }
+    uint32_t getDamageTypeKey() const { return damageTypeKey; }
+};
+
+// 帧事件内存区 - 线性分配，事件就地构造，一帧结束后一次性重置
+// 内存块在帧间复用，稳定后不再向系统申请内存
+class EventArena {
+public:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+    
+private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> data;
+        size_t size;
+    };
+    
+    std::vector<Block> blocks;
+    size_t currentBlock;
+    size_t offset;
+    std::vector<GameEvent*> liveEvents;  // 重置时需要析构的事件
+    
+    void* allocate(size_t size, size_t alignment) {
+        while (currentBlock < blocks.size()) {
+            Block& block = blocks[currentBlock];
+            uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+            size_t aligned = (base + offset + alignment - 1) / alignment * alignment - base;
+            if (aligned + size <= block.size) {
+                offset = aligned + size;
+                return block.data.get() + aligned;
+            }
+            ++currentBlock;
+            offset = 0;
+        }
+        
+        size_t blockSize = std::max(BLOCK_SIZE, size + alignment);
+        blocks.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[blockSize]), blockSize});
+        currentBlock = blocks.size() - 1;
+        offset = 0;
+        return allocate(size, alignment);
+    }
+    
+public:
+    EventArena() : currentBlock(0), offset(0) {}
+    EventArena(const EventArena&) = delete;
+    EventArena& operator=(const EventArena&) = delete;
+    ~EventArena() { reset(); }
+    
+    template<typename T, typename... Args>
+    T* emplace(Args&&... args) {
+        static_assert(std::is_base_of<GameEvent, T>::value, "EventArena只存放GameEvent");
+        void* memory = allocate(sizeof(T), alignof(T));
+        T* event = new (memory) T(std::forward<Args>(args)...);
+        liveEvents.push_back(event);
+        return event;
+    }
+    
+    // 析构全部事件并回到第一个内存块
+    void reset() {
+        for (GameEvent* event : liveEvents) {
+            event->~GameEvent();
+        }
+        liveEvents.clear();
+        currentBlock = 0;
+        offset = 0;
+    }
+    
+    size_t getEventCount() const { return liveEvents.size(); }
+    
+    size_t getReservedBytes() const {
+        size_t total = 0;
+        for (const auto& block : blocks) {
+            total += block.size;
+        }
+        return total;
+    }
+};
+
+// 多生产者事件队列 - 有界无锁队列（Vyukov算法），单一消费者
+// 网络、物理、AI线程按值投递事件；游戏线程在每帧处理前把截止点之前的事件
+// 搬进帧内存区，截止点之后投递的事件留到下一帧，不丢失也不重复
+class ConcurrentEventQueue {
+public:
+    static constexpr size_t PAYLOAD_SIZE = 64;
+    
+private:
+    using Relocate = GameEvent* (*)(void* storage, EventArena& arena);
+    
+    struct Cell {
+        std::atomic<size_t> sequence;
+        Relocate relocate;
+        alignas(std::max_align_t) unsigned char storage[PAYLOAD_SIZE];
+    };
+    
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enqueuePos;
+    alignas(64) size_t dequeuePos;  // 只由消费者线程访问
+    
+    // 把槽位中的事件移动到帧内存区，并析构槽位中的副本
+    template<typename T>
+    static GameEvent* relocateTo(void* storage, EventArena& arena) {
+        T* source = static_cast<T*>(storage);
+        T* event = arena.emplace<T>(std::move(*source));
+        source->~T();
+        return event;
+    }
+    
+public:
+    // 容量必须是2的幂
+    explicit ConcurrentEventQueue(size_t capacity)
+        : cells(new Cell[capacity]), mask(capacity - 1), enqueuePos(0), dequeuePos(0) {
+        if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+            throw std::invalid_argument("ConcurrentEventQueue容量必须是2的幂");
+        }
+        for (size_t i = 0; i < capacity; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    
+    ConcurrentEventQueue(const ConcurrentEventQueue&) = delete;
+    ConcurrentEventQueue& operator=(const ConcurrentEventQueue&) = delete;
+    
+    ~ConcurrentEventQueue() {
+        // 丢弃尚未取出的事件
+        EventArena scratch;
+        drain(scratch, [](GameEvent*) {});
+    }
+    
+    // 任意线程调用；队列满时返回false，由生产者决定重试或丢弃
+    template<typename T>
+    bool push(const T& event) {
+        static_assert(std::is_base_of<GameEvent, T>::value, "只能投递GameEvent");
+        static_assert(sizeof(T) <= PAYLOAD_SIZE, "事件超过队列槽位大小");
+        static_assert(alignof(T) <= alignof(std::max_align_t), "事件对齐要求过高");
+        
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // 队列已满
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        
+        new (cell->storage) T(event);
+        cell->relocate = &relocateTo<T>;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // 仅消费者线程调用：取出截止点前的全部事件，依次交给sink，返回数量
+    // 截止点之前已占位但尚未写完的槽位会短暂等待生产者完成
+    template<typename Sink>
+    size_t drain(EventArena& arena, Sink&& sink) {
+        const size_t cutover = enqueuePos.load(std::memory_order_acquire);
+        size_t drained = 0;
+        while (dequeuePos != cutover) {
+            Cell* cell = &cells[dequeuePos & mask];
+            while (cell->sequence.load(std::memory_order_acquire) != dequeuePos + 1) {
+                std::this_thread::yield();
+            }
+            sink(cell->relocate(cell->storage, arena));
+            cell->sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+            ++dequeuePos;
+            ++drained;
+        }
+        return drained;
+    }
+    
+    size_t getCapacity() const { return mask + 1; }
 };
 
 // 处理者抽象基类
@@ -82,14 +374,41 @@ public:
     // 处理请求的方法
     virtual void handleEvent(GameEvent* event) {
         if (canHandle(event)) {
-            processEvent(event);
-            event->setHandled(true);
-        } else if (nextHandler) {
+            if (handleSingle(event)) {
+                return;
+            }
+        }
+        if (nextHandler) {
             // 传递给链中的下一个处理者
             nextHandler->handleEvent(event);
         }
     }
     
+    // 只由本处理者处理事件（不沿链传递），返回事件是否已终结
+    bool handleSingle(GameEvent* event) {
+        processEvent(event);
+        if (continuesChain()) {
+            return false;
+        }
+        event->setHandled(true);
+        return true;
+    }
+    
+    // 先用canHandle检查实际事件，能处理时才交给handleSingle；返回事件是否已终结
+    bool tryHandle(GameEvent* event) {
+        return canHandle(event) && handleSingle(event);
+    }
+    
+    // 只按类型判断是否可能处理该类型的事件，用于预编译分发表的候选列表，
+    // 分发时仍会对实际事件调用canHandle。默认接受所有类型，按类型过滤的处理者应重写以缩小候选列表
+    virtual bool acceptsType(GameEvent::EventType type) {
+        (void)type;
+        return true;
+    }
+    
+    EventHandler* getNext() const { return nextHandler.get(); }
+    bool passesThrough() const { return continuesChain(); }
+    
 protected:
     // 判断是否能处理该事件
     virtual bool canHandle(GameEvent* event) = 0;
@@ -97,6 +416,9 @@ protected:
     // 实际处理事件的方法
     virtual void processEvent(GameEvent* event) = 0;
     
+    // 处理后是否继续交给后续处理者（用于修正类处理者，如防御减免）
+    virtual bool continuesChain() const { return false; }
+    
 public:
     const std::string& getName() const { return handlerName; }
 };
@@ -106,6 +428,10 @@ class InputHandler : public EventHandler {
 public:
     InputHandler() : EventHandler("输入处理器") {}
     
+    bool acceptsType(GameEvent::EventType type) override {
+        return type == GameEvent::INPUT_EVENT;
+    }
+    
 protected:
     bool canHandle(GameEvent* event) override {
         return event->getType() == GameEvent::INPUT_EVENT;
@@ -149,7 +475,14 @@ private:
 // 具体处理者 - 伤害处理器
 class DamageHandler : public EventHandler {
 public:
-    DamageHandler() : EventHandler("伤害处理器") {}
+    DamageHandler()
+        : EventHandler("伤害处理器"),
+          fireKey(EventStringTable::getInstance().intern("fire")),
+          iceKey(EventStringTable::getInstance().intern("ice")) {}
+    
+    bool acceptsType(GameEvent::EventType type) override {
+        return type == GameEvent::DAMAGE_EVENT;
+    }
     
 protected:
     bool canHandle(GameEvent* event) override {
@@ -168,13 +501,17 @@ protected:
     }
     
 private:
+    // 伤害类型在构造时驻留一次，之后只比较ID
+    uint32_t fireKey;
+    uint32_t iceKey;
+    
     int calculateFinalDamage(DamageEvent* event) {
         int baseDamage = event->getDamage();
         
         // 根据伤害类型应用修正
-        if (event->getDamageType() == "fire") {
+        if (event->getDamageTypeKey() == fireKey) {
             return static_cast<int>(baseDamage * 1.2f);  // 火焰伤害+20%
-        } else if (event->getDamageType() == "ice") {
+        } else if (event->getDamageTypeKey() == iceKey) {
             return static_cast<int>(baseDamage * 0.8f);  // 冰霜伤害-20%
         }
         
@@ -192,6 +529,10 @@ class DefenseHandler : public EventHandler {
 public:
     DefenseHandler() : EventHandler("防御处理器") {}
     
+    bool acceptsType(GameEvent::EventType type) override {
+        return type == GameEvent::DAMAGE_EVENT;
+    }
+    
 protected:
     bool canHandle(GameEvent* event) override {
         // 只处理伤害事件，用于计算防御减免
@@ -210,8 +551,10 @@ protected:
         // 不设置为已处理，让后续处理者继续处理
     }
     
+    bool continuesChain() const override { return true; }
+    
 private:
-    int getTargetDefense(const std::string& targetId) {
+    int getTargetDefense(std::string_view targetId) {
         // 获取目标的防御值
         // return findTarget(targetId)->getDefense();
         return 10;  // 示例值
@@ -221,7 +564,14 @@ private:
 // 具体处理者 - 特殊效果处理器
 class SpecialEffectHandler : public EventHandler {
 public:
-    SpecialEffectHandler() : EventHandler("特殊效果处理器") {}
+    SpecialEffectHandler()
+        : EventHandler("特殊效果处理器"),
+          poisonKey(EventStringTable::getInstance().intern("poison")),
+          stunKey(EventStringTable::getInstance().intern("stun")) {}
+    
+    bool acceptsType(GameEvent::EventType type) override {
+        return type == GameEvent::DAMAGE_EVENT;
+    }
     
 protected:
     bool canHandle(GameEvent* event) override {
@@ -232,31 +582,64 @@ protected:
         DamageEvent* damageEvent = static_cast<DamageEvent*>(event);
         
         // 应用特殊效果
-        if (damageEvent->getDamageType() == "poison") {
+        if (damageEvent->getDamageTypeKey() == poisonKey) {
             applyPoisonEffect(damageEvent->getTargetId());
-        } else if (damageEvent->getDamageType() == "stun") {
+        } else if (damageEvent->getDamageTypeKey() == stunKey) {
             applyStunEffect(damageEvent->getTargetId());
         }
     }
     
+    // 特殊效果附加在伤害之上，最终伤害由伤害处理器结算
+    bool continuesChain() const override { return true; }
+    
 private:
-    void applyPoisonEffect(const std::string& targetId) {
+    uint32_t poisonKey;
+    uint32_t stunKey;
+    
+    void applyPoisonEffect(std::string_view targetId) {
         // 应用中毒效果
     }
     
-    void applyStunEffect(const std::string& targetId) {
+    void applyStunEffect(std::string_view targetId) {
         // 应用眩晕效果
     }
 };
 
 // 事件管理器 - 管理责任链
+// 编译模式下按事件类型预先算出有序的处理者列表，分发时直接按类型下标查表
 class EventManager {
 private:
     std::unique_ptr<EventHandler> handlerChain;
     std::vector<GameEvent*> eventQueue;
+    EventArena frameArena;  // emplaceEvent()创建的事件，processEvents()后统一释放
+    ConcurrentEventQueue incoming;  // 其他线程通过postEvent()投递的事件
+    
+    // 编译分发表：每种事件类型按链顺序可能处理它的候选处理者。
+    // 是否处理、是否终结取决于实际事件（canHandle），所以表里不截断，分发时逐个tryHandle
+    std::vector<EventHandler*> dispatchTable[GameEvent::EVENT_TYPE_COUNT];
+    bool compiledDispatch;
+    bool dispatchTableDirty;
+    std::vector<GameEvent*> sortedQueue;  // 批处理时按类型排序的队列
+    std::vector<uint8_t> terminated;      // 批处理时各事件是否已被某个处理者终结
+    
+    void rebuildDispatchTable() {
+        for (int type = 0; type < GameEvent::EVENT_TYPE_COUNT; ++type) {
+            auto& handlers = dispatchTable[type];
+            handlers.clear();
+            for (EventHandler* h = handlerChain.get(); h; h = h->getNext()) {
+                if (h->acceptsType(static_cast<GameEvent::EventType>(type))) {
+                    handlers.push_back(h);
+                }
+            }
+        }
+        dispatchTableDirty = false;
+    }
     
 public:
-    EventManager() {
+    static constexpr size_t DEFAULT_INCOMING_CAPACITY = 1024;
+    
+    explicit EventManager(size_t incomingCapacity = DEFAULT_INCOMING_CAPACITY)
+        : incoming(incomingCapacity), compiledDispatch(false), dispatchTableDirty(true) {
         setupHandlerChain();
     }
     
@@ -267,33 +650,137 @@ public:
         auto effectHandler = std::make_unique<SpecialEffectHandler>();
         auto damageHandler = std::make_unique<DamageHandler>();
         
-        // 建立链式关系
-        inputHandler->setNext(std::move(defenseHandler));
-        inputHandler->setNext(std::move(effectHandler));
+        // 建立链式关系（从尾部向前连接）
         effectHandler->setNext(std::move(damageHandler));
+        defenseHandler->setNext(std::move(effectHandler));
+        inputHandler->setNext(std::move(defenseHandler));
         
         handlerChain = std::move(inputHandler);
+        dispatchTableDirty = true;
     }
     
+    // 添加调用方持有的事件
     void addEvent(GameEvent* event) {
         eventQueue.push_back(event);
     }
     
+    // 线程安全：从任意线程按值投递事件，在下一次processEvents()时处理
+    // 队列满时返回false
+    template<typename T>
+    bool postEvent(const T& event) {
+        return incoming.push(event);
+    }
+    
+    // 在帧内存区就地构造事件并入队，本次处理结束后自动释放
+    template<typename T, typename... Args>
+    T* emplaceEvent(Args&&... args) {
+        T* event = frameArena.emplace<T>(std::forward<Args>(args)...);
+        eventQueue.push_back(event);
+        return event;
+    }
+    
     void processEvents() {
-        for (auto* event : eventQueue) {
-            if (handlerChain) {
-                handlerChain->handleEvent(event);
+        PROFILE_SUBSYSTEM(ProfileSubsystem::Events, "EventManager::processEvents");
+        drainIncoming();
+        if (compiledDispatch) {
+            if (dispatchTableDirty) {
+                rebuildDispatchTable();
+            }
+            for (auto* event : eventQueue) {
+                dispatch(event);
+            }
+        } else {
+            for (auto* event : eventQueue) {
+                if (handlerChain) {
+                    handlerChain->handleEvent(event);
+                }
             }
         }
         
         // 清理已处理的事件
+        PROFILE_COUNT(ProfileCounter::EventsDispatched, eventQueue.size());
+        eventQueue.clear();
+        frameArena.reset();
+    }
+    
+    // 批处理：先把队列按类型排序，再让每个处理者依次处理同类型的连续区间
+    // 同类型事件间的相对顺序保持不变，不同类型之间不保证原顺序
+    void processEventsBatched() {
+        PROFILE_SUBSYSTEM(ProfileSubsystem::Events, "EventManager::processEventsBatched");
+        drainIncoming();
+        if (dispatchTableDirty) {
+            rebuildDispatchTable();
+        }
+        
+        // 计数排序
+        size_t offsets[GameEvent::EVENT_TYPE_COUNT + 1] = {};
+        for (auto* event : eventQueue) {
+            ++offsets[event->getType() + 1];
+        }
+        for (int type = 0; type < GameEvent::EVENT_TYPE_COUNT; ++type) {
+            offsets[type + 1] += offsets[type];
+        }
+        sortedQueue.resize(eventQueue.size());
+        size_t cursor[GameEvent::EVENT_TYPE_COUNT];
+        std::copy(offsets, offsets + GameEvent::EVENT_TYPE_COUNT, cursor);
+        for (auto* event : eventQueue) {
+            sortedQueue[cursor[event->getType()]++] = event;
+        }
+        
+        // 已被终结的事件不再交给后面的处理者，与逐个沿链处理的结果一致
+        terminated.assign(sortedQueue.size(), 0);
+        for (int type = 0; type < GameEvent::EVENT_TYPE_COUNT; ++type) {
+            for (EventHandler* handler : dispatchTable[type]) {
+                for (size_t i = offsets[type]; i < offsets[type + 1]; ++i) {
+                    if (!terminated[i] && handler->tryHandle(sortedQueue[i])) {
+                        terminated[i] = 1;
+                    }
+                }
+            }
+        }
+        
+        PROFILE_COUNT(ProfileCounter::EventsDispatched, eventQueue.size());
         eventQueue.clear();
+        frameArena.reset();
     }
     
+    // 开启/关闭编译分发模式
+    void setCompiledDispatch(bool enabled) {
+        compiledDispatch = enabled;
+    }
+    
+    bool isCompiledDispatch() const { return compiledDispatch; }
+    
     // 动态添加处理者到链的开头
     void addHandlerToChain(std::unique_ptr<EventHandler> newHandler) {
         newHandler->setNext(std::move(handlerChain));
         handlerChain = std::move(newHandler);
+        dispatchTableDirty = true;
+    }
+    
+    // 某类型事件在编译分发表中的候选处理者数量
+    size_t getHandlerCount(GameEvent::EventType type) {
+        if (dispatchTableDirty) {
+            rebuildDispatchTable();
+        }
+        return dispatchTable[type].size();
+    }
+    
+private:
+    // 帧截止：把其他线程已投递的事件搬入本帧队列
+    void drainIncoming() {
+        incoming.drain(frameArena, [this](GameEvent* event) {
+            eventQueue.push_back(event);
+        });
+    }
+    
+    // 按类型直接查表分发
+    void dispatch(GameEvent* event) {
+        for (EventHandler* handler : dispatchTable[event->getType()]) {
+            if (handler->tryHandle(event)) {
+                break;
+            }
+        }
     }
 };
 
@@ -302,6 +789,10 @@ class UIEventHandler : public EventHandler {
 public:
     UIEventHandler() : EventHandler("UI事件处理器") {}
     
+    bool acceptsType(GameEvent::EventType type) override {
+        return type == GameEvent::UI_EVENT;
+    }
+    
 protected:
     bool canHandle(GameEvent* event) override {
         return event->getType() == GameEvent::UI_EVENT;
@@ -326,22 +817,21 @@ public:
     }
     
     void playerAttack(const std::string& targetId, int damage, const std::string& damageType) {
-        // 创建伤害事件并添加到事件队列
-        auto damageEvent = new DamageEvent(damage, damageType, targetId);
-        eventManager.addEvent(damageEvent);
+        // 在帧内存区创建伤害事件并添加到事件队列
+        eventManager.emplaceEvent<DamageEvent>(damage, damageType, targetId);
         
         // 立即处理事件
         eventManager.processEvents();
-        
-        delete damageEvent;
+    }
+    
+    // 只入队不立即处理，留到processFrame()统一处理（大量伤害事件时使用）
+    void queueAttack(std::string_view targetId, int damage, uint32_t damageTypeKey) {
+        eventManager.emplaceEvent<DamageEvent>(damage, damageTypeKey, targetId);
     }
     
     void handleInput(int keyCode, bool isDown) {
-        auto inputEvent = new InputEvent(keyCode, isDown);
-        eventManager.addEvent(inputEvent);
+        eventManager.emplaceEvent<InputEvent>(keyCode, isDown);
         eventManager.processEvents();
-        
-        delete inputEvent;
     }
     
     void processFrame() {
@@ -1,8 +1,13 @@
 #pragma once
 #include <memory>
 #include <vector>
-#include <stack>
 #include <string>
+#include <cmath>
+#include <new>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
 
 /**
  * 命令模式 (Command Pattern)
@@ -10,6 +15,73 @@
  * 特点：将请求封装为对象，从而支持撤销、排队等操作
  */
 
+// 命令内存池 - 按16字节分级的线程本地空闲链表
+// 命令对象的new/delete都经过这里，高频输入不再每次调用全局new
+class CommandPool {
+public:
+    static constexpr size_t GRANULARITY = 16;
+    static constexpr size_t MAX_POOLED_SIZE = 256;
+    static constexpr size_t CLASS_COUNT = MAX_POOLED_SIZE / GRANULARITY;
+    static constexpr size_t BLOCKS_PER_CHUNK = 64;
+    
+    static void* allocate(size_t size) {
+        if (size == 0) {
+            size = 1;
+        }
+        if (size > MAX_POOLED_SIZE) {
+            return ::operator new(size);
+        }
+        FreeBlock*& head = freeLists()[(size - 1) / GRANULARITY];
+        if (!head) {
+            head = refill((size - 1) / GRANULARITY);
+        }
+        FreeBlock* block = head;
+        head = block->next;
+        return block;
+    }
+    
+    static void deallocate(void* ptr, size_t size) {
+        if (!ptr) {
+            return;
+        }
+        if (size == 0) {
+            size = 1;
+        }
+        if (size > MAX_POOLED_SIZE) {
+            ::operator delete(ptr);
+            return;
+        }
+        FreeBlock*& head = freeLists()[(size - 1) / GRANULARITY];
+        FreeBlock* block = static_cast<FreeBlock*>(ptr);
+        block->next = head;
+        head = block;
+    }
+    
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    
+    static FreeBlock** freeLists() {
+        thread_local FreeBlock* lists[CLASS_COUNT] = {};
+        return lists;
+    }
+    
+    // 分配一整块并切分成空闲链表
+    // 块在进程生命周期内不归还系统，因此空闲块可以安全地在线程间迁移
+    static FreeBlock* refill(size_t sizeClass) {
+        size_t blockSize = (sizeClass + 1) * GRANULARITY;
+        char* chunk = static_cast<char*>(::operator new(blockSize * BLOCKS_PER_CHUNK));
+        FreeBlock* head = nullptr;
+        for (size_t i = BLOCKS_PER_CHUNK; i-- > 0;) {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + i * blockSize);
+            block->next = head;
+            head = block;
+        }
+        return head;
+    }
+};
+
 // 命令接口
 class Command {
 public:
@@ -17,6 +89,10 @@ public:
     virtual void execute() = 0;
     virtual void undo() = 0;
     virtual std::string getName() const = 0;
+    
+    // 所有命令从命令内存池分配（虚析构保证delete时传入实际大小）
+    static void* operator new(size_t size) { return CommandPool::allocate(size); }
+    static void operator delete(void* ptr, size_t size) { CommandPool::deallocate(ptr, size); }
 };
 
 // 接收者 - 游戏角色
@@ -199,116 +275,347 @@ public:
     }
 };
 
+// 命令历史 - 固定容量环形缓冲区
+// [最旧 ... 可撤销 | 可重做 ... ]，满时覆盖最旧的记录，O(1)淘汰
+class CommandHistory {
+private:
+    std::vector<std::unique_ptr<Command>> entries;
+    size_t start;       // 最旧记录所在位置
+    size_t undoCount;   // 可撤销的记录数
+    size_t redoCount;   // 紧随其后的可重做记录数
+    
+    size_t slot(size_t offset) const { return (start + offset) % entries.size(); }
+    
+public:
+    explicit CommandHistory(size_t capacity)
+        : entries(capacity), start(0), undoCount(0), redoCount(0) {}
+    
+    // 记录已执行的命令：丢弃重做记录，满时淘汰最旧的命令
+    void push(std::unique_ptr<Command> command) {
+        clearRedo();
+        if (entries.empty()) {
+            return;
+        }
+        if (undoCount == entries.size()) {
+            entries[start].reset();
+            start = slot(1);
+            --undoCount;
+        }
+        entries[slot(undoCount)] = std::move(command);
+        ++undoCount;
+    }
+    
+    // 取出最近一条可撤销命令（所有权仍在历史中）
+    Command* popUndo() {
+        if (undoCount == 0) {
+            return nullptr;
+        }
+        --undoCount;
+        ++redoCount;
+        return entries[slot(undoCount)].get();
+    }
+    
+    Command* popRedo() {
+        if (redoCount == 0) {
+            return nullptr;
+        }
+        Command* command = entries[slot(undoCount)].get();
+        ++undoCount;
+        --redoCount;
+        return command;
+    }
+    
+    const Command* peekUndo() const {
+        return undoCount > 0 ? entries[slot(undoCount - 1)].get() : nullptr;
+    }
+    
+    void clearRedo() {
+        for (size_t i = 0; i < redoCount; ++i) {
+            entries[slot(undoCount + i)].reset();
+        }
+        redoCount = 0;
+    }
+    
+    void clear() {
+        for (auto& entry : entries) {
+            entry.reset();
+        }
+        start = undoCount = redoCount = 0;
+    }
+    
+    size_t getUndoCount() const { return undoCount; }
+    size_t getRedoCount() const { return redoCount; }
+    size_t getCapacity() const { return entries.size(); }
+};
+
 // 调用者 - 命令管理器
 class CommandManager {
 private:
-    std::stack<std::unique_ptr<Command>> undoStack;
-    std::stack<std::unique_ptr<Command>> redoStack;
-    size_t maxHistorySize;
+    CommandHistory history;
     
 public:
-    CommandManager(size_t maxSize = 50) : maxHistorySize(maxSize) {}
+    CommandManager(size_t maxSize = 50) : history(maxSize) {}
     
     void executeCommand(std::unique_ptr<Command> command) {
         // 执行命令
         command->execute();
         
-        // 添加到撤销栈
-        undoStack.push(std::move(command));
-        
-        // 清空重做栈（执行新命令后无法重做之前撤销的操作）
-        while (!redoStack.empty()) {
-            redoStack.pop();
-        }
-        
-        // 限制历史记录大小
-        if (undoStack.size() > maxHistorySize) {
-            // 移除最底部的命令（需要临时栈）
-            std::stack<std::unique_ptr<Command>> tempStack;
-            while (undoStack.size() > 1) {
-                tempStack.push(std::move(undoStack.top()));
-                undoStack.pop();
-            }
-            undoStack.pop();  // 移除最底部命令
-            
-            while (!tempStack.empty()) {
-                undoStack.push(std::move(tempStack.top()));
-                tempStack.pop();
-            }
-        }
+        // 添加到历史（清空重做记录；超过上限时淘汰最旧的命令）
+        history.push(std::move(command));
     }
     
     bool undo() {
-        if (!undoStack.empty()) {
-            auto command = std::move(undoStack.top());
-            undoStack.pop();
-            
+        if (Command* command = history.popUndo()) {
             command->undo();
-            redoStack.push(std::move(command));
             return true;
         }
         return false;
     }
     
     bool redo() {
-        if (!redoStack.empty()) {
-            auto command = std::move(redoStack.top());
-            redoStack.pop();
-            
+        if (Command* command = history.popRedo()) {
             command->execute();
-            undoStack.push(std::move(command));
             return true;
         }
         return false;
     }
     
-    bool canUndo() const { return !undoStack.empty(); }
-    bool canRedo() const { return !redoStack.empty(); }
+    bool canUndo() const { return history.getUndoCount() > 0; }
+    bool canRedo() const { return history.getRedoCount() > 0; }
+    size_t getHistorySize() const { return history.getUndoCount(); }
+    size_t getMaxHistorySize() const { return history.getCapacity(); }
     
     std::string getLastCommandName() const {
-        if (!undoStack.empty()) {
-            return undoStack.top()->getName();
+        if (const Command* command = history.peekUndo()) {
+            return command->getName();
         }
         return "无命令";
     }
     
     void clearHistory() {
-        while (!undoStack.empty()) undoStack.pop();
-        while (!redoStack.empty()) redoStack.pop();
+        history.clear();
+    }
+};
+
+// 命令流 - 用于录制、回放和网络帧同步的紧凑POD命令格式
+// 每条记录固定16字节，连续追加存放，整段可以直接memcpy或发送
+enum class CommandOpcode : uint16_t {
+    FrameMarker = 0,  // 帧分隔：entityId为帧号
+    Move = 1,         // args.f = {dx, dy}
+    Attack = 2,       // targetId = 目标, args.i[1] = 伤害
+    Heal = 3,         // args.i[1] = 治疗量
+};
+
+struct CommandRecord {
+    CommandOpcode opcode;
+    uint16_t flags;
+    uint32_t entityId;
+    union {
+        float f[2];
+        int32_t i[2];
+    } args;
+    
+    uint32_t getTargetId() const { return static_cast<uint32_t>(args.i[0]); }
+};
+
+static_assert(sizeof(CommandRecord) == 16, "CommandRecord必须保持16字节");
+static_assert(std::is_trivially_copyable<CommandRecord>::value, "CommandRecord必须可按字节拷贝");
+
+// 实体表 - 命令流中的实体ID到角色的映射
+class CommandEntityTable {
+private:
+    std::vector<GameCharacter*> entities;
+    std::unordered_map<const GameCharacter*, uint32_t> ids;   // 反向索引，录制端按指针查ID
+    
+public:
+    uint32_t registerEntity(GameCharacter* character) {
+        entities.push_back(character);
+        uint32_t id = static_cast<uint32_t>(entities.size() - 1);
+        ids.emplace(character, id);   // 重复注册时保留最早的ID
+        return id;
     }
+    
+    GameCharacter* find(uint32_t id) const {
+        return id < entities.size() ? entities[id] : nullptr;
+    }
+    
+    // 按指针查找ID，未注册返回UINT32_MAX
+    uint32_t idOf(const GameCharacter* character) const {
+        auto it = ids.find(character);
+        return it != ids.end() ? it->second : UINT32_MAX;
+    }
+    
+    size_t size() const { return entities.size(); }
+};
+
+// 命令流读取器 - 直接在外部字节缓冲区上迭代，不拷贝整段数据
+class CommandStreamReader {
+private:
+    const unsigned char* bytes;
+    size_t count;
+    
+public:
+    CommandStreamReader(const void* data, size_t byteSize)
+        : bytes(static_cast<const unsigned char*>(data)), count(byteSize / sizeof(CommandRecord)) {}
+    
+    size_t size() const { return count; }
+    
+    // 缓冲区可能来自网络而未对齐，逐条按字节读出
+    CommandRecord at(size_t index) const {
+        CommandRecord record;
+        std::memcpy(&record, bytes + index * sizeof(CommandRecord), sizeof(CommandRecord));
+        return record;
+    }
+    
+    // 取[begin, end)子区间
+    CommandStreamReader slice(size_t begin, size_t end) const {
+        end = end < count ? end : count;
+        begin = begin < end ? begin : end;
+        return CommandStreamReader(bytes + begin * sizeof(CommandRecord),
+                                   (end - begin) * sizeof(CommandRecord));
+    }
+    
+    // 从begin开始查找下一帧分隔位置，找不到返回size()
+    size_t findFrameEnd(size_t begin) const {
+        for (size_t i = begin; i < count; ++i) {
+            if (at(i).opcode == CommandOpcode::FrameMarker) {
+                return i;
+            }
+        }
+        return count;
+    }
+};
+
+// 命令流 - 只追加的连续记录缓冲区
+class CommandStream {
+private:
+    std::vector<CommandRecord> records;
+    
+    void push(CommandOpcode opcode, uint32_t entityId, int32_t a, int32_t b) {
+        CommandRecord record{};
+        record.opcode = opcode;
+        record.entityId = entityId;
+        record.args.i[0] = a;
+        record.args.i[1] = b;
+        records.push_back(record);
+    }
+    
+public:
+    void reserve(size_t recordCount) { records.reserve(recordCount); }
+    
+    void beginFrame(uint32_t frame) { push(CommandOpcode::FrameMarker, frame, 0, 0); }
+    
+    void move(uint32_t entityId, float dx, float dy) {
+        CommandRecord record{};
+        record.opcode = CommandOpcode::Move;
+        record.entityId = entityId;
+        record.args.f[0] = dx;
+        record.args.f[1] = dy;
+        records.push_back(record);
+    }
+    
+    void attack(uint32_t attackerId, uint32_t targetId, int damage) {
+        push(CommandOpcode::Attack, attackerId, static_cast<int32_t>(targetId), damage);
+    }
+    
+    void heal(uint32_t entityId, int amount) {
+        push(CommandOpcode::Heal, entityId, 0, amount);
+    }
+    
+    void append(const CommandRecord& record) { records.push_back(record); }
+    
+    // 追加整段外部字节（如网络包），按记录大小截断
+    void appendBytes(const void* data, size_t byteSize) {
+        size_t n = byteSize / sizeof(CommandRecord);
+        size_t old = records.size();
+        records.resize(old + n);
+        std::memcpy(records.data() + old, data, n * sizeof(CommandRecord));
+    }
+    
+    const void* data() const { return records.data(); }
+    size_t byteSize() const { return records.size() * sizeof(CommandRecord); }
+    size_t size() const { return records.size(); }
+    void clear() { records.clear(); }
+    
+    CommandStreamReader reader() const { return CommandStreamReader(data(), byteSize()); }
 };
 
+// 批量执行命令区间，跳过帧分隔和未知实体，返回执行的命令数
+inline size_t executeCommands(const CommandStreamReader& range, const CommandEntityTable& table) {
+    size_t executed = 0;
+    for (size_t i = 0; i < range.size(); ++i) {
+        CommandRecord record = range.at(i);
+        GameCharacter* character = table.find(record.entityId);
+        if (!character) {
+            continue;
+        }
+        switch (record.opcode) {
+            case CommandOpcode::Move:
+                character->setPosition(character->getX() + record.args.f[0],
+                                       character->getY() + record.args.f[1]);
+                break;
+            case CommandOpcode::Attack:
+                if (GameCharacter* target = table.find(record.getTargetId())) {
+                    character->attack();
+                    target->takeDamage(record.args.i[1]);
+                }
+                break;
+            case CommandOpcode::Heal:
+                character->heal(record.args.i[1]);
+                break;
+            default:
+                continue;
+        }
+        ++executed;
+    }
+    return executed;
+}
+
 // 输入处理器 - 将输入转换为命令
 class InputProcessor {
 private:
     CommandManager* commandManager;
     GameCharacter* controlledCharacter;
+    CommandStream* recorder;     // 可选：同时录制到命令流
+    uint32_t recordedEntityId;
     
 public:
     InputProcessor(CommandManager* cmdMgr, GameCharacter* character)
-        : commandManager(cmdMgr), controlledCharacter(character) {}
+        : commandManager(cmdMgr), controlledCharacter(character),
+          recorder(nullptr), recordedEntityId(0) {}
     
     void handleKeyPress(int keyCode) {
-        std::unique_ptr<Command> command = nullptr;
+        float dx = 0, dy = 0;
         
         switch (keyCode) {
             case 87: // W键 - 向上移动
-                command = std::make_unique<MoveCommand>(controlledCharacter, 0, 10);
+                dy = 10;
                 break;
             case 83: // S键 - 向下移动
-                command = std::make_unique<MoveCommand>(controlledCharacter, 0, -10);
+                dy = -10;
                 break;
             case 65: // A键 - 向左移动
-                command = std::make_unique<MoveCommand>(controlledCharacter, -10, 0);
+                dx = -10;
                 break;
             case 68: // D键 - 向右移动
-                command = std::make_unique<MoveCommand>(controlledCharacter, 10, 0);
+                dx = 10;
                 break;
+            default:
+                return;
         }
         
-        if (command && commandManager) {
-            commandManager->executeCommand(std::move(command));
+        if (recorder) {
+            recorder->move(recordedEntityId, dx, dy);
         }
+        if (commandManager) {
+            commandManager->executeCommand(std::make_unique<MoveCommand>(controlledCharacter, dx, dy));
+        }
+    }
+    
+    // 将之后的输入以entityId录制到命令流，传nullptr停止录制
+    void setRecorder(CommandStream* stream, uint32_t entityId) {
+        recorder = stream;
+        recordedEntityId = entityId;
     }
     
     void handleUndoRedo(int keyCode) {
@@ -350,6 +657,21 @@ public:
         }
     }
     
+    // 直接生成POD命令记录，不创建命令对象（用于录制和帧同步）
+    void planActions(const std::vector<GameCharacter*>& enemies, CommandStream& out,
+                     const CommandEntityTable& table) const {
+        uint32_t selfId = table.idOf(aiCharacter);
+        for (auto* enemy : enemies) {
+            if (isInRange(enemy)) {
+                out.attack(selfId, table.idOf(enemy), 25);
+            } else {
+                float dx, dy;
+                moveTowards(enemy, dx, dy);
+                out.move(selfId, dx, dy);
+            }
+        }
+    }
+    
     void executeNextAction(CommandManager* commandManager) {
         if (!commandQueue.empty() && commandManager) {
             auto command = std::move(commandQueue.front());
@@ -374,9 +696,9 @@ private:
         return distance <= 50.0f;  // 攻击范围50像素
     }
     
-    std::unique_ptr<Command> createMoveTowardsCommand(GameCharacter* target) {
-        float dx = target->getX() - aiCharacter->getX();
-        float dy = target->getY() - aiCharacter->getY();
+    void moveTowards(const GameCharacter* target, float& dx, float& dy) const {
+        dx = target->getX() - aiCharacter->getX();
+        dy = target->getY() - aiCharacter->getY();
         
         // 标准化移动向量
         float length = std::sqrt(dx * dx + dy * dy);
@@ -384,7 +706,11 @@ private:
             dx = (dx / length) * 20;  // 移动速度20像素
             dy = (dy / length) * 20;
         }
-        
+    }
+    
+    std::unique_ptr<Command> createMoveTowardsCommand(GameCharacter* target) {
+        float dx, dy;
+        moveTowards(target, dx, dy);
         return std::make_unique<MoveCommand>(aiCharacter, dx, dy);
     }
 };
@@ -396,12 +722,15 @@ private:
     InputProcessor inputProcessor;
     std::vector<std::unique_ptr<CommandAIController>> aiControllers;
     std::vector<std::unique_ptr<GameCharacter>> characters;
+    CommandEntityTable entityTable;
+    CommandStream recording;  // 本场战斗的输入录像
     
 public:
     BattleController() : inputProcessor(&commandManager, nullptr) {
         // 创建玩家角色
         auto player = std::make_unique<GameCharacter>("玩家", 100, 100, 150);
         inputProcessor.setControlledCharacter(player.get());
+        inputProcessor.setRecorder(&recording, entityTable.registerEntity(player.get()));
         characters.push_back(std::move(player));
         
         // 创建AI角色
@@ -411,6 +740,7 @@ public:
             
             auto aiController = std::make_unique<CommandAIController>(enemy.get());
             aiControllers.push_back(std::move(aiController));
+            entityTable.registerEntity(enemy.get());
             characters.push_back(std::move(enemy));
         }
     }
@@ -458,6 +788,13 @@ public:
         commandManager.executeCommand(std::move(macro));
     }
     
+    // 回放命令流（录像或网络收到的帧命令），返回执行的命令数
+    size_t replay(const CommandStreamReader& commands) {
+        return executeCommands(commands, entityTable);
+    }
+    
+    const CommandStream& getRecording() const { return recording; }
+    
     bool canUndo() const { return commandManager.canUndo(); }
     bool canRedo() const { return commandManager.canRedo(); }
     std::string getLastCommand() const { return commandManager.getLastCommandName(); }
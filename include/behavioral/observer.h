@@ -3,6 +3,13 @@
 #include <memory>
 #include <functional>
 #include <string>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include "structural/profiler.h"
 
 /**
  * 观察者模式 (Observer Pattern)
@@ -12,47 +19,275 @@
 
 // 前向声明
 class Subject;
+class NotificationQueue;
 
 // 观察者接口
 class Observer {
 public:
+    static constexpr uint32_t ALL_CHANNELS = 0xFFFFFFFFu;
+    
     virtual ~Observer() = default;
     virtual void update(Subject* subject) = 0;
     virtual std::string getObserverName() const = 0;
+    
+    // 关心的变化通道（位掩码），attach时默认使用
+    virtual uint32_t getInterestMask() const { return ALL_CHANNELS; }
+    
+    // 带变化通道的通知，默认转发到update()
+    virtual void onChanged(Subject* subject, uint32_t /*changedChannels*/) {
+        update(subject);
+    }
 };
 
 // 主题接口
+// 状态变化通过markDirty(通道)上报：立即模式下马上通知关心这些通道的观察者；
+// 延迟模式下只累积脏标记，由flushNotifications()或NotificationQueue每帧合并通知一次
+//
+// 观察者列表采用写时复制：notify()无锁地遍历当前发布的快照，attach/detach先排队，
+// 在没有进行中的通知时生成新快照发布。旧快照等所有进行中的通知结束后才回收，
+// 因此在update()里detach、或在UI/音频线程上订阅都是安全的
 class Subject {
 protected:
-    std::vector<Observer*> observers;
+    struct Subscription {
+        Observer* observer;
+        uint32_t interestMask;
+    };
+    
+    struct ObserverList {
+        std::vector<Subscription> subscriptions;
+    };
+    
+    struct PendingChange {
+        Observer* observer;
+        uint32_t interestMask;
+        bool attach;
+    };
+    
+    std::atomic<const ObserverList*> snapshot{nullptr};
+    std::atomic<int> activeNotifications{0};
+    std::atomic<bool> hasPendingChanges{false};
+    
+    std::mutex registryMutex;                 // 保护以下写端状态
+    std::vector<PendingChange> pendingChanges;
+    std::vector<const ObserverList*> retiredLists;
+    
+    std::atomic<uint32_t> dirtyChannels{0};
+    bool deferred = false;
+    NotificationQueue* notificationQueue = nullptr;
+    
+    inline void markDirty(uint32_t channels);
+    
+    // 在通知间隙应用排队的订阅变化，并回收不再被读取的旧快照
+    void applyPendingChanges() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        if (!pendingChanges.empty()) {
+            const ObserverList* old = snapshot.load(std::memory_order_relaxed);
+            auto* next = new ObserverList(old ? *old : ObserverList());
+            auto& subs = next->subscriptions;
+            for (const auto& change : pendingChanges) {
+                if (change.attach) {
+                    subs.push_back({change.observer, change.interestMask});
+                } else {
+                    subs.erase(std::remove_if(subs.begin(), subs.end(),
+                        [&change](const Subscription& s) { return s.observer == change.observer; }),
+                        subs.end());
+                }
+            }
+            pendingChanges.clear();
+            hasPendingChanges.store(false, std::memory_order_relaxed);
+            snapshot.store(next, std::memory_order_seq_cst);  // 发布新快照
+            if (old) {
+                retiredLists.push_back(old);
+            }
+        }
+        reclaimRetiredLists();
+    }
+    
+    // 调用方需持有registryMutex
+    void reclaimRetiredLists() {
+        // 发布新快照之后若没有读者，之后开始的通知只能读到新快照
+        if (!retiredLists.empty() && activeNotifications.load(std::memory_order_seq_cst) == 0) {
+            for (const ObserverList* list : retiredLists) {
+                delete list;
+            }
+            retiredLists.clear();
+        }
+    }
+    
+    void queueChange(const PendingChange& change) {
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            pendingChanges.push_back(change);
+            hasPendingChanges.store(true, std::memory_order_release);
+        }
+        if (activeNotifications.load(std::memory_order_seq_cst) == 0) {
+            applyPendingChanges();
+        }
+    }
     
 public:
-    virtual ~Subject() = default;
+    Subject() = default;
+    Subject(const Subject&) = delete;
+    Subject& operator=(const Subject&) = delete;
+    inline virtual ~Subject();
     
     void attach(Observer* observer) {
-        observers.push_back(observer);
+        attach(observer, observer->getInterestMask());
+    }
+    
+    // 只订阅指定通道
+    void attach(Observer* observer, uint32_t interestMask) {
+        queueChange({observer, interestMask, true});
     }
     
+    // 进行中的通知仍可能把本次通知送达该观察者；销毁观察者前可调用synchronize()
     void detach(Observer* observer) {
-        observers.erase(
-            std::remove(observers.begin(), observers.end(), observer),
-            observers.end()
-        );
+        queueChange({observer, 0, false});
     }
     
+    // 应用排队的变化并等待所有进行中的通知结束
+    void synchronize() {
+        applyPendingChanges();
+        while (activeNotifications.load(std::memory_order_seq_cst) != 0) {
+            std::this_thread::yield();
+        }
+        std::lock_guard<std::mutex> lock(registryMutex);
+        reclaimRetiredLists();
+    }
+    
+    // 通知所有观察者（不区分通道）
     void notify() {
-        for (auto* observer : observers) {
-            observer->update(this);
+        notifyChannels(Observer::ALL_CHANNELS);
+    }
+    
+    // 通知订阅了任一给定通道的观察者，任意线程可调用
+    void notifyChannels(uint32_t channels) {
+        if (hasPendingChanges.load(std::memory_order_acquire) &&
+            activeNotifications.load(std::memory_order_seq_cst) == 0) {
+            applyPendingChanges();
+        }
+        
+        activeNotifications.fetch_add(1, std::memory_order_seq_cst);
+        uint64_t delivered = 0;
+        if (const ObserverList* list = snapshot.load(std::memory_order_seq_cst)) {
+            for (const auto& s : list->subscriptions) {
+                if (s.interestMask & channels) {
+                    s.observer->onChanged(this, channels);
+                    ++delivered;
+                }
+            }
+        }
+        PROFILE_COUNT(ProfileCounter::ObserverNotifications, delivered);
+        if (activeNotifications.fetch_sub(1, std::memory_order_seq_cst) == 1 &&
+            hasPendingChanges.load(std::memory_order_acquire)) {
+            applyPendingChanges();  // 最后一个通知结束，应用期间排队的变化
         }
     }
     
+    // 开启延迟模式；queue非空时，首次变脏会把主题登记到队列等待统一刷新
+    inline void setDeferredNotifications(bool enabled, NotificationQueue* queue = nullptr);
+    
+    // 合并发送累积的变化通知
+    void flushNotifications() {
+        uint32_t channels = dirtyChannels.exchange(0, std::memory_order_acq_rel);
+        if (channels) {
+            notifyChannels(channels);
+        }
+    }
+    
+    uint32_t getDirtyChannels() const { return dirtyChannels.load(std::memory_order_relaxed); }
+    
     size_t getObserverCount() const {
-        return observers.size();
+        const ObserverList* list = snapshot.load(std::memory_order_acquire);
+        return list ? list->subscriptions.size() : 0;
     }
 };
 
+// 通知队列 - 收集本帧变脏的主题，每帧刷新一次
+// 只访问真正变化过的主题，开销与变化数量成正比；可从多个线程登记
+class NotificationQueue {
+private:
+    std::mutex mutex;
+    std::vector<Subject*> pending;
+    std::vector<Subject*> flushing;
+    
+public:
+    void enqueue(Subject* subject) {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(subject);
+    }
+    
+    void remove(Subject* subject) {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.erase(std::remove(pending.begin(), pending.end(), subject), pending.end());
+    }
+    
+    // 刷新期间新变脏的主题留到下一次
+    void flush() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            flushing.swap(pending);
+        }
+        for (Subject* subject : flushing) {
+            subject->flushNotifications();
+        }
+        flushing.clear();  // 保留容量供下一帧复用
+    }
+    
+    size_t getPendingCount() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return pending.size();
+    }
+};
+
+inline void Subject::markDirty(uint32_t channels) {
+    if (!deferred) {
+        notifyChannels(channels);
+        return;
+    }
+    uint32_t previous = dirtyChannels.fetch_or(channels, std::memory_order_acq_rel);
+    if (previous == 0 && notificationQueue) {
+        notificationQueue->enqueue(this);
+    }
+}
+
+inline Subject::~Subject() {
+    if (notificationQueue) {
+        notificationQueue->remove(this);
+    }
+    delete snapshot.load(std::memory_order_relaxed);
+    for (const ObserverList* list : retiredLists) {
+        delete list;
+    }
+}
+
+inline void Subject::setDeferredNotifications(bool enabled, NotificationQueue* queue) {
+    if (notificationQueue) {
+        notificationQueue->remove(this);
+    }
+    deferred = enabled;
+    notificationQueue = enabled ? queue : nullptr;
+    if (getDirtyChannels()) {
+        if (notificationQueue) {
+            notificationQueue->enqueue(this);
+        } else if (!deferred) {
+            flushNotifications();
+        }
+    }
+}
+
 // 具体主题 - 游戏玩家
 class Player : public Subject {
+public:
+    // 变化通道
+    enum Channel : uint32_t {
+        HEALTH_CHANGED = 1u << 0,      // 生命值或生命上限
+        EXPERIENCE_CHANGED = 1u << 1,
+        LEVEL_CHANGED = 1u << 2,
+        SCORE_CHANGED = 1u << 3,
+        POSITION_CHANGED = 1u << 4,
+    };
+    
 private:
     std::string name;
     int health;
@@ -72,7 +307,7 @@ public:
         health = std::max(0, health - damage);
         
         if (health != oldHealth) {
-            notify();  // 通知观察者生命值变化
+            markDirty(HEALTH_CHANGED);  // 通知观察者生命值变化
         }
         
         if (health <= 0) {
@@ -85,7 +320,7 @@ public:
         health = std::min(maxHealth, health + amount);
         
         if (health != oldHealth) {
-            notify();
+            markDirty(HEALTH_CHANGED);
         }
     }
     
@@ -99,7 +334,7 @@ public:
             levelUp();
         }
         
-        notify();
+        markDirty(EXPERIENCE_CHANGED);
     }
     
     void levelUp() {
@@ -107,20 +342,20 @@ public:
         maxHealth += 20;
         health = maxHealth;  // 升级时恢复满血
         
-        notify();  // 通知升级事件
+        markDirty(LEVEL_CHANGED | HEALTH_CHANGED);  // 通知升级事件
     }
     
     // 分数相关
     void addScore(int points) {
         score += points;
-        notify();
+        markDirty(SCORE_CHANGED);
     }
     
     // 位置相关
     void setPosition(float newX, float newY) {
         x = newX;
         y = newY;
-        notify();
+        markDirty(POSITION_CHANGED);
     }
     
     // 访问器
@@ -171,6 +406,8 @@ public:
         return "血条UI (" + uiElementId + ")";
     }
     
+    uint32_t getInterestMask() const override { return Player::HEALTH_CHANGED; }
+    
 private:
     void updateHealthDisplay(int health, int maxHealth) {
         float healthPercent = static_cast<float>(health) / maxHealth * 100;
@@ -211,6 +448,10 @@ public:
         return "经验条UI (" + uiElementId + ")";
     }
     
+    uint32_t getInterestMask() const override {
+        return Player::EXPERIENCE_CHANGED | Player::LEVEL_CHANGED;
+    }
+    
 private:
     void updateExperienceDisplay(int level, int exp) {
         int requiredExp = level * 100;
@@ -252,6 +493,8 @@ public:
         return "分数显示 (" + displayId + ")";
     }
     
+    uint32_t getInterestMask() const override { return Player::SCORE_CHANGED; }
+    
 private:
     void updateScoreDisplay(int score) {
         // updateTextElement(displayId, "Score: " + std::to_string(score));
@@ -288,6 +531,8 @@ public:
         return "音效管理器";
     }
     
+    uint32_t getInterestMask() const override { return Player::HEALTH_CHANGED; }
+    
     void setSoundEnabled(bool enabled) { soundEnabled = enabled; }
     
 private:
@@ -316,6 +561,10 @@ public:
         return "成就系统";
     }
     
+    uint32_t getInterestMask() const override {
+        return Player::LEVEL_CHANGED | Player::SCORE_CHANGED | Player::HEALTH_CHANGED;
+    }
+    
     const std::vector<std::string>& getUnlockedAchievements() const {
         return unlockedAchievements;
     }
@@ -374,6 +623,8 @@ public:
         return "小地图 (" + mapId + ")";
     }
     
+    uint32_t getInterestMask() const override { return Player::POSITION_CHANGED; }
+    
 private:
     void updatePlayerPositionOnMap(float x, float y) {
         // updateMapMarker(mapId, x, y);
@@ -429,6 +680,7 @@ public:
 // 游戏会话 - 展示观察者模式的完整应用
 class GameSession {
 private:
+    NotificationQueue notificationQueue;  // 每帧统一刷新的变化通知
     std::unique_ptr<Player> player;
     std::unique_ptr<GameEventManager> eventManager;
     
@@ -439,6 +691,14 @@ public:
         
         // 设置所有观察者
         eventManager->setupPlayerObservers(player.get());
+        
+        // 玩家状态变化合并到帧末统一通知
+        player->setDeferredNotifications(true, &notificationQueue);
+    }
+    
+    // 帧末：合并发送本帧的全部变化通知
+    void endFrame() {
+        notificationQueue.flush();
     }
     
     ~GameSession() {
@@ -468,6 +728,8 @@ public:
         
         // 玩家继续获得经验（可能升级）
         player->gainExperience(75);
+        
+        endFrame();
     }
     
     Player* getPlayer() const { return player.get(); }
@@ -1,7 +1,11 @@
 #pragma once
 #include <memory>
 #include <string>
-#include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include "creational/factory_registry.h"
 
 /**
  * 状态模式 (State Pattern)
@@ -12,7 +16,53 @@
 // 前向声明
 class StateCharacter;
 
+// 状态编号 - 状态表和转换矩阵都按它索引
+enum class StateId : uint8_t {
+    Idle,
+    Walking,
+    Jumping,
+    Attacking,
+    Casting,
+    Count
+};
+
+constexpr size_t STATE_COUNT = static_cast<size_t>(StateId::Count);
+
+constexpr size_t stateIndex(StateId id) { return static_cast<size_t>(id); }
+
+constexpr const char* STATE_NAMES[STATE_COUNT] = {
+    "idle", "walking", "jumping", "attacking", "casting"
+};
+
+// 状态转换矩阵 [当前状态][目标状态]
+constexpr bool STATE_TRANSITIONS[STATE_COUNT][STATE_COUNT] = {
+    //            idle   walking jumping attacking casting
+    /* idle */      {false, true,   true,   true,     true },  // 空闲状态可以转换到任何其他状态
+    /* walking */   {true,  false,  true,   true,     false},
+    /* jumping */   {true,  false,  false,  true,     false},
+    /* attacking */ {true,  false,  true,   false,    false},  // 只能回到空闲或跳跃
+    /* casting */   {true,  true,   false,  false,    false},  // 可以被移动打断
+};
+
+constexpr bool canTransition(StateId from, StateId to) {
+    return STATE_TRANSITIONS[stateIndex(from)][stateIndex(to)];
+}
+
+static_assert(canTransition(StateId::Idle, StateId::Casting), "空闲状态应可施法");
+static_assert(!canTransition(StateId::Jumping, StateId::Casting), "空中不能施法");
+
+// 名字到编号的映射，只在外部以字符串指定状态时使用
+inline StateId stateIdFromName(const std::string& stateName) {
+    for (size_t i = 0; i < STATE_COUNT; ++i) {
+        if (stateName == STATE_NAMES[i]) {
+            return static_cast<StateId>(i);
+        }
+    }
+    return StateId::Count;
+}
+
 // 状态接口
+// 状态对象无成员数据，所有角色共享同一份实例；计时等按角色变化的数据保存在角色上
 class CharacterState {
 public:
     virtual ~CharacterState() = default;
@@ -23,15 +73,40 @@ public:
     virtual void onEnter(StateCharacter* character) = 0;
     virtual void onExit(StateCharacter* character) = 0;
     
-    virtual std::string getStateName() const = 0;
-    virtual bool canTransitionTo(const std::string& newState) const = 0;
+    virtual StateId getStateId() const = 0;
+    
+    std::string getStateName() const { return STATE_NAMES[stateIndex(getStateId())]; }
+    
+    bool canTransitionTo(StateId newState) const {
+        return canTransition(getStateId(), newState);
+    }
+    
+    bool canTransitionTo(const std::string& newState) const {
+        StateId id = stateIdFromName(newState);
+        return id != StateId::Count && canTransitionTo(id);
+    }
 };
 
+// 共享状态表，定义在具体状态之后
+inline CharacterState* getSharedState(StateId id);
+
+class StateMachineManager;
+
 // 上下文类 - 游戏角色
 class StateCharacter {
 private:
-    std::unique_ptr<CharacterState> currentState;
-    std::unordered_map<std::string, std::unique_ptr<CharacterState>> states;
+    CharacterState* currentState = nullptr;  // 指向共享状态表，切换状态不分配内存
+    StateId currentStateId = StateId::Count;
+    float stateTimer = 0.0f;                 // 当前状态已持续的时间（攻击、施法计时）
+    
+    // 批量更新分桶信息，由StateMachineManager维护
+    StateMachineManager* bucketOwner = nullptr;
+    uint32_t bucketSlot = 0;
+    uint32_t lastBatchFrame = 0;
+    
+    friend class StateMachineManager;
+    
+    inline void onBucketChanged(StateId previous);  // 在StateMachineManager之后实现
     
     // 角色属性
     std::string name;
@@ -47,11 +122,12 @@ public:
         : name(charName), x(0), y(0), health(100), maxHealth(100), 
           moveSpeed(100.0f), isGrounded(true), jumpVelocity(0), mana(50), maxMana(50) {
         
-        initializeStates();
-        setState("idle");
+        setState(StateId::Idle);
     }
     
-    void initializeStates();  // 在类定义后实现
+    StateCharacter(const StateCharacter&) = delete;
+    StateCharacter& operator=(const StateCharacter&) = delete;
+    inline ~StateCharacter();
     
     void handleInput(int inputCode) {
         if (currentState) {
@@ -65,28 +141,40 @@ public:
         }
     }
     
-    void setState(const std::string& stateName) {
-        auto it = states.find(stateName);
-        if (it != states.end()) {
-            // 检查是否可以转换到新状态
-            if (!currentState || currentState->canTransitionTo(stateName)) {
-                if (currentState) {
-                    currentState->onExit(this);
-                }
-                
-                currentState = std::move(it->second);
-                currentState->onEnter(this);
-                
-                // 重新创建状态实例（用于下次使用）
-                createStateInstance(stateName);
+    void setState(StateId newState) {
+        if (newState == StateId::Count) {
+            return;
+        }
+        // 检查是否可以转换到新状态
+        if (!currentState || canTransition(currentStateId, newState)) {
+            if (currentState) {
+                currentState->onExit(this);
+            }
+            
+            StateId previous = currentStateId;
+            currentStateId = newState;
+            currentState = getSharedState(newState);
+            stateTimer = 0.0f;
+            if (bucketOwner) {
+                onBucketChanged(previous);
             }
+            currentState->onEnter(this);
         }
     }
     
+    void setState(const std::string& stateName) {
+        setState(stateIdFromName(stateName));
+    }
+    
+    StateId getCurrentStateId() const { return currentStateId; }
+    
     std::string getCurrentStateName() const {
         return currentState ? currentState->getStateName() : "无状态";
     }
     
+    float getStateTimer() const { return stateTimer; }
+    void advanceStateTimer(float deltaTime) { stateTimer += deltaTime; }
+    
     // 访问器和修改器
     const std::string& getName() const { return name; }
     float getX() const { return x; }
@@ -108,31 +196,28 @@ public:
     
     int getMana() const { return mana; }
     void setMana(int mp) { mana = std::max(0, std::min(maxMana, mp)); }
-    
-private:
-    void createStateInstance(const std::string& stateName);  // 在类定义后实现
 };
 
 // 具体状态 - 空闲状态
-class IdleState : public CharacterState {
+class IdleState final : public CharacterState {
 public:
     void handleInput(StateCharacter* character, int inputCode) override {
         switch (inputCode) {
             case 65: // A键 - 向左移动
             case 68: // D键 - 向右移动
-                character->setState("walking");
+                character->setState(StateId::Walking);
                 break;
             case 32: // 空格键 - 跳跃
                 if (character->getIsGrounded()) {
-                    character->setState("jumping");
+                    character->setState(StateId::Jumping);
                 }
                 break;
             case 74: // J键 - 攻击
-                character->setState("attacking");
+                character->setState(StateId::Attacking);
                 break;
             case 75: // K键 - 施法
                 if (character->getMana() >= 10) {
-                    character->setState("casting");
+                    character->setState(StateId::Casting);
                 }
                 break;
         }
@@ -157,19 +242,13 @@ public:
         // 退出空闲状态时的处理
     }
     
-    std::string getStateName() const override { return "idle"; }
-    
-    bool canTransitionTo(const std::string& newState) const override {
-        // 空闲状态可以转换到任何其他状态
-        return newState == "walking" || newState == "jumping" || 
-               newState == "attacking" || newState == "casting";
-    }
+    StateId getStateId() const override { return StateId::Idle; }
 };
 
 // 具体状态 - 行走状态
-class WalkingState : public CharacterState {
+class WalkingState final : public CharacterState {
 private:
-    float walkSpeed = 100.0f;
+    static constexpr float walkSpeed = 100.0f;
     
 public:
     void handleInput(StateCharacter* character, int inputCode) override {
@@ -182,14 +261,14 @@ public:
                 break;
             case 32: // 空格键 - 跳跃
                 if (character->getIsGrounded()) {
-                    character->setState("jumping");
+                    character->setState(StateId::Jumping);
                 }
                 break;
             case 74: // J键 - 攻击
-                character->setState("attacking");
+                character->setState(StateId::Attacking);
                 break;
             case 0: // 没有输入
-                character->setState("idle");
+                character->setState(StateId::Idle);
                 break;
         }
     }
@@ -208,18 +287,14 @@ public:
         character->setMoveSpeed(0);
     }
     
-    std::string getStateName() const override { return "walking"; }
-    
-    bool canTransitionTo(const std::string& newState) const override {
-        return newState == "idle" || newState == "jumping" || newState == "attacking";
-    }
+    StateId getStateId() const override { return StateId::Walking; }
 };
 
 // 具体状态 - 跳跃状态
-class JumpingState : public CharacterState {
+class JumpingState final : public CharacterState {
 private:
-    float jumpForce = 300.0f;
-    float gravity = -500.0f;
+    static constexpr float jumpForce = 300.0f;
+    static constexpr float gravity = -500.0f;
     
 public:
     void handleInput(StateCharacter* character, int inputCode) override {
@@ -232,7 +307,7 @@ public:
                 character->move(50 * 0.016f, 0);
                 break;
             case 74: // J键 - 空中攻击
-                character->setState("attacking");
+                character->setState(StateId::Attacking);
                 break;
         }
     }
@@ -251,7 +326,7 @@ public:
             character->setPosition(character->getX(), 0);
             character->setGrounded(true);
             character->setJumpVelocity(0);
-            character->setState("idle");
+            character->setState(StateId::Idle);
         }
     }
     
@@ -266,18 +341,13 @@ public:
         // playAnimation("land");
     }
     
-    std::string getStateName() const override { return "jumping"; }
-    
-    bool canTransitionTo(const std::string& newState) const override {
-        return newState == "idle" || newState == "attacking";
-    }
+    StateId getStateId() const override { return StateId::Jumping; }
 };
 
 // 具体状态 - 攻击状态
-class AttackingState : public CharacterState {
+class AttackingState final : public CharacterState {
 private:
-    float attackDuration = 0.5f;  // 攻击持续时间
-    float attackTimer = 0.0f;
+    static constexpr float attackDuration = 0.5f;  // 攻击持续时间
     
 public:
     void handleInput(StateCharacter* character, int inputCode) override {
@@ -286,20 +356,19 @@ public:
     }
     
     void update(StateCharacter* character, float deltaTime) override {
-        attackTimer += deltaTime;
+        character->advanceStateTimer(deltaTime);
         
         // 攻击结束后回到空闲状态
-        if (attackTimer >= attackDuration) {
+        if (character->getStateTimer() >= attackDuration) {
             if (character->getIsGrounded()) {
-                character->setState("idle");
+                character->setState(StateId::Idle);
             } else {
-                character->setState("jumping");
+                character->setState(StateId::Jumping);
             }
         }
     }
     
     void onEnter(StateCharacter* character) override {
-        attackTimer = 0.0f;
         character->setMoveSpeed(0);  // 攻击时停止移动
         // playAnimation("attack");
         // playSoundEffect("sword_swing.wav");
@@ -312,12 +381,7 @@ public:
         // 攻击状态结束
     }
     
-    std::string getStateName() const override { return "attacking"; }
-    
-    bool canTransitionTo(const std::string& newState) const override {
-        // 攻击状态只能转换到空闲或跳跃状态
-        return newState == "idle" || newState == "jumping";
-    }
+    StateId getStateId() const override { return StateId::Attacking; }
     
 private:
     void performAttack(StateCharacter* character) {
@@ -327,37 +391,35 @@ private:
 };
 
 // 具体状态 - 施法状态
-class CastingState : public CharacterState {
+class CastingState final : public CharacterState {
 private:
-    float castDuration = 1.0f;  // 施法时间
-    float castTimer = 0.0f;
-    int manaCost = 10;
+    static constexpr float castDuration = 1.0f;  // 施法时间
+    static constexpr int manaCost = 10;
     
 public:
     void handleInput(StateCharacter* character, int inputCode) override {
         // 施法可以被移动打断
         if (inputCode == 65 || inputCode == 68) {  // A或D键
-            character->setState("walking");
+            character->setState(StateId::Walking);
         }
     }
     
     void update(StateCharacter* character, float deltaTime) override {
-        castTimer += deltaTime;
+        character->advanceStateTimer(deltaTime);
         
-        if (castTimer >= castDuration) {
+        if (character->getStateTimer() >= castDuration) {
             // 施法完成
             castSpell(character);
-            character->setState("idle");
+            character->setState(StateId::Idle);
         }
     }
     
     void onEnter(StateCharacter* character) override {
-        castTimer = 0.0f;
         character->setMoveSpeed(0);
         
         // 检查魔法值是否足够
         if (character->getMana() < manaCost) {
-            character->setState("idle");
+            character->setState(StateId::Idle);
             return;
         }
         
@@ -366,17 +428,13 @@ public:
     }
     
     void onExit(StateCharacter* character) override {
-        if (castTimer < castDuration) {
+        if (character->getStateTimer() < castDuration) {
             // 施法被打断，不消耗魔法值
             // playSoundEffect("spell_interrupted.wav");
         }
     }
     
-    std::string getStateName() const override { return "casting"; }
-    
-    bool canTransitionTo(const std::string& newState) const override {
-        return newState == "idle" || newState == "walking";
-    }
+    StateId getStateId() const override { return StateId::Casting; }
     
 private:
     void castSpell(StateCharacter* character) {
@@ -389,61 +447,187 @@ private:
     }
 };
 
-// 状态工厂
-class StateFactory {
+// 共享状态表 - 每种状态一个实例，按StateId索引
+class StateTable {
+private:
+    IdleState idle;
+    WalkingState walking;
+    JumpingState jumping;
+    AttackingState attacking;
+    CastingState casting;
+    CharacterState* table[STATE_COUNT];
+    
+    StateTable() : table{&idle, &walking, &jumping, &attacking, &casting} {}
+    
 public:
-    static std::unique_ptr<CharacterState> createState(const std::string& stateName) {
-        if (stateName == "idle") {
-            return std::make_unique<IdleState>();
-        } else if (stateName == "walking") {
-            return std::make_unique<WalkingState>();
-        } else if (stateName == "jumping") {
-            return std::make_unique<JumpingState>();
-        } else if (stateName == "attacking") {
-            return std::make_unique<AttackingState>();
-        } else if (stateName == "casting") {
-            return std::make_unique<CastingState>();
-        }
-        return nullptr;
+    static StateTable& getInstance() {
+        static StateTable instance;
+        return instance;
     }
+    
+    CharacterState* get(StateId id) { return table[stateIndex(id)]; }
 };
 
-// 实现之前声明的方法
-void GameCharacter::initializeStates() {
-    states["idle"] = StateFactory::createState("idle");
-    states["walking"] = StateFactory::createState("walking");
-    states["jumping"] = StateFactory::createState("jumping");
-    states["attacking"] = StateFactory::createState("attacking");
-    states["casting"] = StateFactory::createState("casting");
+inline CharacterState* getSharedState(StateId id) {
+    return StateTable::getInstance().get(id);
 }
 
-void GameCharacter::createStateInstance(const std::string& stateName) {
-    states[stateName] = StateFactory::createState(stateName);
-}
+// 状态工厂 - 需要独立状态对象时使用，角色本身使用共享状态表
+// 注册顺序与StateId一致，按编号创建就是查表
+using StateRegistry = FactoryRegistry<CharacterState, IdleState, WalkingState, JumpingState, AttackingState, CastingState>;
+using StateHolder = StateRegistry::Holder;
+
+static_assert(StateRegistry::COUNT == STATE_COUNT &&
+              StateRegistry::idOf<IdleState>() == stateIndex(StateId::Idle) &&
+              StateRegistry::idOf<WalkingState>() == stateIndex(StateId::Walking) &&
+              StateRegistry::idOf<JumpingState>() == stateIndex(StateId::Jumping) &&
+              StateRegistry::idOf<AttackingState>() == stateIndex(StateId::Attacking) &&
+              StateRegistry::idOf<CastingState>() == stateIndex(StateId::Casting),
+              "状态注册表顺序必须与StateId一致");
+
+class StateFactory {
+public:
+    static std::unique_ptr<CharacterState> createState(StateId id) {
+        return StateRegistry::create(stateIndex(id));
+    }
+    
+    static std::unique_ptr<CharacterState> createState(const std::string& stateName) {
+        return createState(stateIdFromName(stateName));
+    }
+    
+    // 在内联缓冲区中创建，无效编号时返回nullptr
+    static CharacterState* createState(StateId id, StateHolder& holder) {
+        return StateRegistry::emplace(stateIndex(id), holder);
+    }
+};
 
 // 状态机管理器 - 用于调试和监控
+// 角色按当前状态分桶，状态切换时增量地在桶间移动（交换删除，O(1)）。
+// 批量模式下逐桶更新：同一桶内每次调用的都是同一个状态的update，
+// 不经过虚函数分派，分支可预测，桶内指针连续并提前预取下一个角色
 class StateMachineManager {
 private:
     std::vector<StateCharacter*> managedCharacters;
+    std::vector<StateCharacter*> buckets[STATE_COUNT];
+    bool batchedUpdate = false;
+    uint32_t batchFrame = 0;
+    
+    void insertIntoBucket(StateCharacter* character, StateId state) {
+        if (state == StateId::Count) {
+            return;
+        }
+        auto& bucket = buckets[stateIndex(state)];
+        character->bucketSlot = static_cast<uint32_t>(bucket.size());
+        bucket.push_back(character);
+    }
+    
+    void removeFromBucket(StateCharacter* character, StateId state) {
+        if (state == StateId::Count) {
+            return;
+        }
+        auto& bucket = buckets[stateIndex(state)];
+        uint32_t slot = character->bucketSlot;
+        StateCharacter* last = bucket.back();
+        bucket[slot] = last;
+        last->bucketSlot = slot;
+        bucket.pop_back();
+    }
+    
+    // 从后往前遍历：当前角色离开本桶时，换进来的是已访问过的元素；
+    // 本帧已更新过的角色（刚转入本桶的）靠帧号跳过
+    template <typename State>
+    void updateBucket(StateId state, float deltaTime) {
+        auto& bucket = buckets[stateIndex(state)];
+        State* handler = static_cast<State*>(getSharedState(state));
+        for (size_t i = bucket.size(); i-- > 0;) {
+            if (i >= bucket.size()) {
+                continue;
+            }
+#if defined(__GNUC__) || defined(__clang__)
+            if (i >= 2) {
+                __builtin_prefetch(bucket[i - 2]);
+            }
+#endif
+            StateCharacter* character = bucket[i];
+            if (character->lastBatchFrame == batchFrame) {
+                continue;
+            }
+            character->lastBatchFrame = batchFrame;
+            handler->State::update(character, deltaTime);
+        }
+    }
     
 public:
+    // 角色保存着指回管理器的指针和桶内位置，副本会和原管理器争用同一批角色，所以不可复制也不可移动
+    StateMachineManager() = default;
+    StateMachineManager(const StateMachineManager&) = delete;
+    StateMachineManager& operator=(const StateMachineManager&) = delete;
+    StateMachineManager(StateMachineManager&&) = delete;
+    StateMachineManager& operator=(StateMachineManager&&) = delete;
+    
+    ~StateMachineManager() {
+        for (auto* character : managedCharacters) {
+            character->bucketOwner = nullptr;
+        }
+    }
+    
     void addCharacter(StateCharacter* character) {
+        if (character->bucketOwner) {
+            return;
+        }
         managedCharacters.push_back(character);
+        character->bucketOwner = this;
+        character->lastBatchFrame = batchFrame;
+        insertIntoBucket(character, character->getCurrentStateId());
     }
     
     void removeCharacter(StateCharacter* character) {
+        if (character->bucketOwner != this) {
+            return;
+        }
+        removeFromBucket(character, character->getCurrentStateId());
+        character->bucketOwner = nullptr;
         managedCharacters.erase(
             std::remove(managedCharacters.begin(), managedCharacters.end(), character),
             managedCharacters.end()
         );
     }
     
+    // 由StateCharacter::setState调用
+    void onCharacterStateChanged(StateCharacter* character, StateId previous) {
+        removeFromBucket(character, previous);
+        insertIntoBucket(character, character->getCurrentStateId());
+    }
+    
+    void setBatchedUpdate(bool enabled) { batchedUpdate = enabled; }
+    bool isBatchedUpdate() const { return batchedUpdate; }
+    
     void updateAllCharacters(float deltaTime) {
+        if (batchedUpdate) {
+            updateBatched(deltaTime);
+            return;
+        }
         for (auto* character : managedCharacters) {
             character->update(deltaTime);
         }
     }
     
+    // 逐状态桶更新，每个角色每帧恰好更新一次
+    void updateBatched(float deltaTime) {
+        ++batchFrame;
+        updateBucket<IdleState>(StateId::Idle, deltaTime);
+        updateBucket<WalkingState>(StateId::Walking, deltaTime);
+        updateBucket<JumpingState>(StateId::Jumping, deltaTime);
+        updateBucket<AttackingState>(StateId::Attacking, deltaTime);
+        updateBucket<CastingState>(StateId::Casting, deltaTime);
+    }
+    
+    size_t getCharacterCount() const { return managedCharacters.size(); }
+    
+    size_t getBucketSize(StateId state) const {
+        return state == StateId::Count ? 0 : buckets[stateIndex(state)].size();
+    }
+    
     void printCharacterStates() const {
         for (const auto* character : managedCharacters) {
             // printf("%s: %s\n", character->getName().c_str(), 
@@ -452,15 +636,25 @@ public:
     }
 };
 
+inline void StateCharacter::onBucketChanged(StateId previous) {
+    bucketOwner->onCharacterStateChanged(this, previous);
+}
+
+inline StateCharacter::~StateCharacter() {
+    if (bucketOwner) {
+        bucketOwner->removeCharacter(this);
+    }
+}
+
 // 游戏控制器 - 展示状态模式的使用
 class PlayerController {
 private:
-    std::unique_ptr<GameCharacter> player;
+    std::unique_ptr<StateCharacter> player;
     StateMachineManager stateManager;
     
 public:
     PlayerController(const std::string& playerName) {
-        player = std::make_unique<GameCharacter>(playerName);
+        player = std::make_unique<StateCharacter>(playerName);
         stateManager.addCharacter(player.get());
     }
     
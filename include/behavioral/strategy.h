@@ -2,6 +2,17 @@
 #include <memory>
 #include <vector>
 #include <string>
+#include <deque>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <cstdint>
+#include <chrono>
+#include <limits>
+#include "structural/profiler.h"
 
 /**
  * 策略模式 (Strategy Pattern)
@@ -12,15 +23,163 @@
 // 前向声明
 class AIEnemy;
 
+// 均匀空间哈希网格 - 每帧重建，半径查询只访问附近的格子并比较距离平方
+// 格子坐标哈希到固定数量的桶，条目按桶做计数排序后连续存放
+class SpatialHashGrid {
+public:
+    struct Entry {
+        float x, y;
+        int32_t cellX, cellY;
+        uint32_t id;
+    };
+    
+private:
+    float cellSize;
+    float inverseCellSize;
+    size_t bucketMask;
+    std::vector<Entry> staging;
+    std::vector<Entry> entries;           // 按桶排序
+    std::vector<uint32_t> bucketStart;    // 桶b的条目为[bucketStart[b], bucketStart[b + 1])
+    std::vector<uint32_t> cursor;         // build()的写入游标，跨帧复用
+    
+    int32_t toCell(float v) const {
+        return static_cast<int32_t>(std::floor(v * inverseCellSize));
+    }
+    
+    size_t bucketOf(int32_t cx, int32_t cy) const {
+        uint32_t h = static_cast<uint32_t>(cx) * 73856093u ^ static_cast<uint32_t>(cy) * 19349663u;
+        return h & bucketMask;
+    }
+    
+public:
+    // bucketCount向上取整为2的幂
+    explicit SpatialHashGrid(float cell = 64.0f, size_t bucketCount = 4096)
+        : cellSize(cell), inverseCellSize(1.0f / cell) {
+        size_t buckets = 1;
+        while (buckets < bucketCount) {
+            buckets <<= 1;
+        }
+        bucketMask = buckets - 1;
+        bucketStart.assign(buckets + 1, 0);
+    }
+    
+    void clear() {
+        staging.clear();
+        entries.clear();
+        std::fill(bucketStart.begin(), bucketStart.end(), 0);
+    }
+    
+    // 插入后需调用build()才能查询
+    void insert(uint32_t id, float x, float y) {
+        staging.push_back({x, y, toCell(x), toCell(y), id});
+    }
+    
+    void build() {
+        size_t bucketCount = bucketMask + 1;
+        std::fill(bucketStart.begin(), bucketStart.end(), 0);
+        for (const auto& e : staging) {
+            bucketStart[bucketOf(e.cellX, e.cellY) + 1]++;
+        }
+        for (size_t b = 0; b < bucketCount; ++b) {
+            bucketStart[b + 1] += bucketStart[b];
+        }
+        entries.resize(staging.size());
+        cursor.assign(bucketStart.begin(), bucketStart.end() - 1);
+        for (const auto& e : staging) {
+            entries[cursor[bucketOf(e.cellX, e.cellY)]++] = e;
+        }
+        staging.clear();
+    }
+    
+    // 对半径内的每个条目调用fn(entry, distanceSq)
+    template <typename Fn>
+    void queryRadius(float x, float y, float radius, Fn&& fn) const {
+        if (entries.empty()) {
+            return;
+        }
+        float radiusSq = radius * radius;
+        int32_t minX = toCell(x - radius), maxX = toCell(x + radius);
+        int32_t minY = toCell(y - radius), maxY = toCell(y + radius);
+        for (int32_t cy = minY; cy <= maxY; ++cy) {
+            for (int32_t cx = minX; cx <= maxX; ++cx) {
+                size_t b = bucketOf(cx, cy);
+                for (uint32_t i = bucketStart[b]; i < bucketStart[b + 1]; ++i) {
+                    const Entry& e = entries[i];
+                    // 不同格子可能哈希到同一个桶，只在条目自己的格子上报告一次
+                    if (e.cellX != cx || e.cellY != cy) {
+                        continue;
+                    }
+                    float dx = e.x - x;
+                    float dy = e.y - y;
+                    float distanceSq = dx * dx + dy * dy;
+                    if (distanceSq <= radiusSq) {
+                        fn(e, distanceSq);
+                    }
+                }
+            }
+        }
+    }
+    
+    // 查找半径内最近的条目，距离相同时取id较小者以保证结果确定
+    bool findNearest(float x, float y, float radius, Entry& out) const {
+        bool found = false;
+        float bestSq = 0.0f;
+        queryRadius(x, y, radius, [&](const Entry& e, float distanceSq) {
+            if (!found || distanceSq < bestSq || (distanceSq == bestSq && e.id < out.id)) {
+                out = e;
+                bestSq = distanceSq;
+                found = true;
+            }
+        });
+        return found;
+    }
+    
+    size_t size() const { return entries.size(); }
+    float getCellSize() const { return cellSize; }
+};
+
+// 内置行为编号 - 共享行为表按它索引
+enum class BehaviorId : uint8_t {
+    Patrol,
+    Chase,
+    Attack,
+    Flee,
+    Defend,
+    Berserk,
+    Easy,       // 难度行为：自行决策，控制器不替换
+    Hard,
+    Count,
+    Custom = 0xFF   // 通过unique_ptr设置的自定义行为
+};
+
+constexpr size_t BEHAVIOR_COUNT = static_cast<size_t>(BehaviorId::Count);
+
+// 战术行为由StrategyAIController按优先级切换
+constexpr bool isTacticalBehavior(BehaviorId id) {
+    return static_cast<uint8_t>(id) < static_cast<uint8_t>(BehaviorId::Easy);
+}
+
+// 每个敌人的行为数据 - 共享行为对象本身不可变，计时和进度都放在这里
+struct AIBlackboard {
+    float behaviorTimer = 0.0f;                     // 攻击冷却、防御计时，切换行为时清零
+    uint16_t waypointIndex = 0;                     // 巡逻进度
+    BehaviorId activeBehavior = BehaviorId::Count;  // 困难AI当前执行的战术行为
+};
+
 // 策略接口 - AI行为策略
+// 行为对象不保存任何敌人相关的状态，同一实例由所有敌人共享
 class AIBehavior {
 public:
     virtual ~AIBehavior() = default;
-    virtual void execute(AIEnemy* enemy, float deltaTime) = 0;
+    virtual void execute(AIEnemy* enemy, float deltaTime) const = 0;
     virtual std::string getBehaviorName() const = 0;
     virtual bool canExecute(AIEnemy* enemy) const = 0;
+    virtual BehaviorId getBehaviorId() const { return BehaviorId::Custom; }
 };
 
+// 共享行为表，定义在具体行为之后
+inline const AIBehavior* getSharedBehavior(BehaviorId id);
+
 // 上下文类 - 敌人
 class AIEnemy {
 private:
@@ -30,12 +189,17 @@ private:
     float speed;
     float detectionRange;
     float attackRange;
-    std::unique_ptr<AIBehavior> currentBehavior;
+    const AIBehavior* currentBehavior = nullptr;   // 通常指向共享行为表
+    std::unique_ptr<AIBehavior> ownedBehavior;     // 仅自定义行为时持有
+    BehaviorId currentBehaviorId = BehaviorId::Count;
+    AIBlackboard blackboard;
     
     // 目标相关
     float targetX, targetY;
     bool hasTarget;
     
+    int pendingAttacks = 0;       // 本帧发起的攻击，由BattleManager统一结算
+    
 public:
     AIEnemy(const std::string& enemyName, float posX = 0, float posY = 0) 
         : name(enemyName), x(posX), y(posY), health(100), maxHealth(100), 
@@ -43,9 +207,26 @@ public:
           targetX(0), targetY(0), hasTarget(false) {}
     
     void setBehavior(std::unique_ptr<AIBehavior> behavior) {
-        currentBehavior = std::move(behavior);
+        ownedBehavior = std::move(behavior);
+        currentBehavior = ownedBehavior.get();
+        currentBehaviorId = currentBehavior ? currentBehavior->getBehaviorId() : BehaviorId::Count;
+        blackboard.behaviorTimer = 0.0f;
+    }
+    
+    // 切换到共享行为，不分配内存
+    void setBehavior(BehaviorId id) {
+        if (id == BehaviorId::Count || id == BehaviorId::Custom) {
+            return;
+        }
+        ownedBehavior.reset();
+        currentBehavior = getSharedBehavior(id);
+        currentBehaviorId = id;
+        blackboard.behaviorTimer = 0.0f;
     }
     
+    BehaviorId getCurrentBehaviorId() const { return currentBehaviorId; }
+    AIBlackboard& getBlackboard() { return blackboard; }
+    
     void update(float deltaTime) {
         if (currentBehavior && currentBehavior->canExecute(this)) {
             currentBehavior->execute(this, deltaTime);
@@ -69,24 +250,30 @@ public:
     
     void patrol(const std::vector<std::pair<float, float>>& waypoints, float deltaTime) {
         // 巡逻逻辑的简化实现
-        static size_t currentWaypoint = 0;
         if (!waypoints.empty()) {
-            auto& target = waypoints[currentWaypoint % waypoints.size()];
+            auto& target = waypoints[blackboard.waypointIndex % waypoints.size()];
             moveTowards(target.first, target.second, deltaTime);
             
             // 如果接近目标点，切换到下一个路点
             float dx = target.first - x;
             float dy = target.second - y;
             if (dx * dx + dy * dy < 25.0f) {  // 5像素范围内
-                currentWaypoint++;
+                blackboard.waypointIndex = static_cast<uint16_t>((blackboard.waypointIndex + 1) % waypoints.size());
             }
         }
     }
     
     void attack() {
-        // 攻击逻辑
+        // 攻击逻辑：只记录在自己身上，伤害结算等跨敌人的效果在更新之后按顺序合并
         // dealDamageToTarget();
         // playAttackAnimation();
+        pendingAttacks++;
+    }
+    
+    int consumePendingAttacks() {
+        int attacks = pendingAttacks;
+        pendingAttacks = 0;
+        return attacks;
     }
     
     void flee(float fromX, float fromY, float deltaTime) {
@@ -128,9 +315,29 @@ public:
     
     float getDistanceToTarget() const {
         if (!hasTarget) return -1.0f;
+        return std::sqrt(getDistanceSqToTarget());
+    }
+    
+    float getDistanceSqToTarget() const {
         float dx = targetX - x;
         float dy = targetY - y;
-        return std::sqrt(dx * dx + dy * dy);
+        return dx * dx + dy * dy;
+    }
+    
+    // 距离平方比较，不开方
+    bool isTargetWithin(float range) const {
+        return hasTarget && getDistanceSqToTarget() <= range * range;
+    }
+    
+    // 在网格中选取侦测范围内最近的目标，没有则清除目标
+    bool acquireTarget(const SpatialHashGrid& targets) {
+        SpatialHashGrid::Entry nearest{};
+        if (targets.findNearest(x, y, detectionRange, nearest)) {
+            setTarget(nearest.x, nearest.y);
+            return true;
+        }
+        clearTarget();
+        return false;
     }
     
     std::string getCurrentBehaviorName() const {
@@ -146,7 +353,7 @@ private:
 public:
     PatrolBehavior(const std::vector<std::pair<float, float>>& points) : waypoints(points) {}
     
-    void execute(AIEnemy* enemy, float deltaTime) override {
+    void execute(AIEnemy* enemy, float deltaTime) const override {
         enemy->patrol(waypoints, deltaTime);
     }
     
@@ -154,6 +361,8 @@ public:
         return "巡逻";
     }
     
+    BehaviorId getBehaviorId() const override { return BehaviorId::Patrol; }
+    
     bool canExecute(AIEnemy* enemy) const override {
         // 巡逻行为总是可以执行，除非敌人死亡
         return enemy->getHealth() > 0;
@@ -167,7 +376,7 @@ public:
 // 具体策略 - 追击行为
 class ChaseBehavior : public AIBehavior {
 public:
-    void execute(AIEnemy* enemy, float deltaTime) override {
+    void execute(AIEnemy* enemy, float deltaTime) const override {
         if (enemy->getHasTarget()) {
             enemy->moveTowards(enemy->getTargetX(), enemy->getTargetY(), deltaTime);
         }
@@ -177,25 +386,27 @@ public:
         return "追击";
     }
     
+    BehaviorId getBehaviorId() const override { return BehaviorId::Chase; }
+    
     bool canExecute(AIEnemy* enemy) const override {
         return enemy->getHealth() > 0 && enemy->getHasTarget() &&
-               enemy->getDistanceToTarget() > enemy->getAttackRange();
+               !enemy->isTargetWithin(enemy->getAttackRange());
     }
 };
 
 // 具体策略 - 攻击行为
 class AttackBehavior : public AIBehavior {
 private:
-    float attackCooldown = 1.0f;  // 攻击冷却时间
-    float lastAttackTime = 0.0f;
+    static constexpr float attackCooldown = 1.0f;  // 攻击冷却时间
     
 public:
-    void execute(AIEnemy* enemy, float deltaTime) override {
-        lastAttackTime += deltaTime;
+    void execute(AIEnemy* enemy, float deltaTime) const override {
+        float& sinceLastAttack = enemy->getBlackboard().behaviorTimer;
+        sinceLastAttack += deltaTime;
         
-        if (lastAttackTime >= attackCooldown) {
+        if (sinceLastAttack >= attackCooldown) {
             enemy->attack();
-            lastAttackTime = 0.0f;
+            sinceLastAttack = 0.0f;
         }
     }
     
@@ -203,16 +414,17 @@ public:
         return "攻击";
     }
     
+    BehaviorId getBehaviorId() const override { return BehaviorId::Attack; }
+    
     bool canExecute(AIEnemy* enemy) const override {
-        return enemy->getHealth() > 0 && enemy->getHasTarget() &&
-               enemy->getDistanceToTarget() <= enemy->getAttackRange();
+        return enemy->getHealth() > 0 && enemy->isTargetWithin(enemy->getAttackRange());
     }
 };
 
 // 具体策略 - 逃跑行为
 class FleeBehavior : public AIBehavior {
 public:
-    void execute(AIEnemy* enemy, float deltaTime) override {
+    void execute(AIEnemy* enemy, float deltaTime) const override {
         if (enemy->getHasTarget()) {
             enemy->flee(enemy->getTargetX(), enemy->getTargetY(), deltaTime);
         }
@@ -222,6 +434,8 @@ public:
         return "逃跑";
     }
     
+    BehaviorId getBehaviorId() const override { return BehaviorId::Flee; }
+    
     bool canExecute(AIEnemy* enemy) const override {
         // 当生命值低于30%时执行逃跑行为
         return enemy->getHealth() > 0 && 
@@ -232,11 +446,11 @@ public:
 // 具体策略 - 防御行为
 class DefendBehavior : public AIBehavior {
 private:
-    float defendDuration = 2.0f;
-    float defendTimer = 0.0f;
+    static constexpr float defendDuration = 2.0f;
     
 public:
-    void execute(AIEnemy* enemy, float deltaTime) override {
+    void execute(AIEnemy* enemy, float deltaTime) const override {
+        float& defendTimer = enemy->getBlackboard().behaviorTimer;
         defendTimer += deltaTime;
         
         // 防御期间减少移动速度
@@ -252,6 +466,8 @@ public:
         return "防御";
     }
     
+    BehaviorId getBehaviorId() const override { return BehaviorId::Defend; }
+    
     bool canExecute(AIEnemy* enemy) const override {
         // 当生命值在30%-60%之间时可能进入防御状态
         float healthPercent = static_cast<float>(enemy->getHealth()) / enemy->getMaxHealth();
@@ -262,7 +478,7 @@ public:
 // 具体策略 - 狂暴行为
 class BerserkBehavior : public AIBehavior {
 public:
-    void execute(AIEnemy* enemy, float deltaTime) override {
+    void execute(AIEnemy* enemy, float deltaTime) const override {
         // 狂暴状态下移动速度和攻击频率增加
         enemy->setSpeed(enemy->getSpeed() * 1.5f);
         
@@ -270,7 +486,7 @@ public:
             enemy->moveTowards(enemy->getTargetX(), enemy->getTargetY(), deltaTime);
             
             // 更频繁的攻击
-            if (enemy->getDistanceToTarget() <= enemy->getAttackRange()) {
+            if (enemy->isTargetWithin(enemy->getAttackRange())) {
                 enemy->attack();
             }
         }
@@ -280,6 +496,8 @@ public:
         return "狂暴";
     }
     
+    BehaviorId getBehaviorId() const override { return BehaviorId::Berserk; }
+    
     bool canExecute(AIEnemy* enemy) const override {
         // 当生命值低于20%时进入狂暴状态
         return enemy->getHealth() > 0 && 
@@ -287,44 +505,125 @@ public:
     }
 };
 
+// 不同难度的AI策略
+class EasyAI : public AIBehavior {
+private:
+    std::vector<std::pair<float, float>> waypoints = {{0, 0}, {50, 0}, {50, 50}, {0, 50}};
+    
+public:
+    void execute(AIEnemy* enemy, float deltaTime) const override {
+        // 简单AI：只会巡逻，反应较慢
+        enemy->patrol(waypoints, deltaTime * 0.5f);  // 移动速度减半
+    }
+    
+    std::string getBehaviorName() const override { return "简单AI"; }
+    bool canExecute(AIEnemy* enemy) const override { return enemy->getHealth() > 0; }
+    BehaviorId getBehaviorId() const override { return BehaviorId::Easy; }
+};
+
+class HardAI : public AIBehavior {
+public:
+    // 困难AI：每帧重新选择战术行为，快速反应
+    inline void execute(AIEnemy* enemy, float deltaTime) const override;  // 在共享行为表之后实现
+    
+    std::string getBehaviorName() const override { return "困难AI"; }
+    bool canExecute(AIEnemy* enemy) const override { return enemy->getHealth() > 0; }
+    BehaviorId getBehaviorId() const override { return BehaviorId::Hard; }
+};
+
+// 共享行为表 - 每种内置行为一个不可变实例，所有敌人共用
+class AIBehaviorRegistry {
+private:
+    PatrolBehavior patrol;
+    ChaseBehavior chase;
+    AttackBehavior attack;
+    FleeBehavior flee;
+    DefendBehavior defend;
+    BerserkBehavior berserk;
+    EasyAI easy;
+    HardAI hard;
+    const AIBehavior* table[BEHAVIOR_COUNT];
+    
+    AIBehaviorRegistry()
+        : patrol(std::vector<std::pair<float, float>>{{0, 0}, {100, 0}, {100, 100}, {0, 100}}),
+          table{&patrol, &chase, &attack, &flee, &defend, &berserk, &easy, &hard} {}
+    
+public:
+    static AIBehaviorRegistry& getInstance() {
+        static AIBehaviorRegistry instance;
+        return instance;
+    }
+    
+    const AIBehavior* get(BehaviorId id) const {
+        return table[static_cast<size_t>(id)];
+    }
+    
+    // 名字到编号，只在外部以名字指定行为时使用
+    BehaviorId findByName(const std::string& behaviorName) const {
+        for (size_t i = 0; i < BEHAVIOR_COUNT; ++i) {
+            if (table[i]->getBehaviorName() == behaviorName) {
+                return static_cast<BehaviorId>(i);
+            }
+        }
+        return BehaviorId::Count;
+    }
+    
+    // 按优先级选择第一个可执行的战术行为
+    // 优先级：逃跑 > 狂暴 > 攻击 > 防御 > 追击 > 巡逻
+    BehaviorId selectBest(AIEnemy* enemy) const {
+        static constexpr BehaviorId priority[] = {
+            BehaviorId::Flee, BehaviorId::Berserk, BehaviorId::Attack,
+            BehaviorId::Defend, BehaviorId::Chase, BehaviorId::Patrol
+        };
+        for (BehaviorId id : priority) {
+            if (get(id)->canExecute(enemy)) {
+                return id;
+            }
+        }
+        return BehaviorId::Count;
+    }
+};
+
+inline const AIBehavior* getSharedBehavior(BehaviorId id) {
+    return AIBehaviorRegistry::getInstance().get(id);
+}
+
+inline void HardAI::execute(AIEnemy* enemy, float deltaTime) const {
+    AIBlackboard& blackboard = enemy->getBlackboard();
+    BehaviorId best = AIBehaviorRegistry::getInstance().selectBest(enemy);
+    if (best == BehaviorId::Count) {
+        return;
+    }
+    if (best != blackboard.activeBehavior) {
+        blackboard.activeBehavior = best;
+        blackboard.behaviorTimer = 0.0f;
+    }
+    getSharedBehavior(best)->execute(enemy, deltaTime * 1.5f);  // 更快的反应速度
+}
+
 // AI控制器 - 管理策略切换
+// 只保存敌人指针和计时，行为对象来自共享行为表
 class StrategyAIController {
 private:
     AIEnemy* controlledEnemy;
-    std::vector<std::unique_ptr<AIBehavior>> availableBehaviors;
     float behaviorUpdateInterval = 1.0f;  // 每秒检查一次行为切换
     float timeSinceLastUpdate = 0.0f;
+    bool externallyScheduled = false;     // 由AIScheduler决定何时重新评估行为
     
 public:
     StrategyAIController(AIEnemy* enemy) : controlledEnemy(enemy) {
-        initializeBehaviors();
-    }
-    }
-    
-    void initializeBehaviors() {
-        // 创建所有可用的行为策略
-        availableBehaviors.push_back(std::make_unique<PatrolBehavior>(
-            std::vector<std::pair<float, float>>{{0, 0}, {100, 0}, {100, 100}, {0, 100}}
-        ));
-        availableBehaviors.push_back(std::make_unique<ChaseBehavior>());
-        availableBehaviors.push_back(std::make_unique<AttackBehavior>());
-        availableBehaviors.push_back(std::make_unique<FleeBehavior>());
-        availableBehaviors.push_back(std::make_unique<DefendBehavior>());
-        availableBehaviors.push_back(std::make_unique<BerserkBehavior>());
-        
         // 设置初始行为
-        controlledEnemy->setBehavior(std::make_unique<PatrolBehavior>(
-            std::vector<std::pair<float, float>>{{0, 0}, {100, 0}, {100, 100}, {0, 100}}
-        ));
+        controlledEnemy->setBehavior(BehaviorId::Patrol);
     }
     
     void update(float deltaTime) {
-        timeSinceLastUpdate += deltaTime;
-        
         // 定期检查是否需要切换行为
-        if (timeSinceLastUpdate >= behaviorUpdateInterval) {
-            selectBestBehavior();
-            timeSinceLastUpdate = 0.0f;
+        if (!externallyScheduled) {
+            timeSinceLastUpdate += deltaTime;
+            if (timeSinceLastUpdate >= behaviorUpdateInterval) {
+                selectBestBehavior();
+                timeSinceLastUpdate = 0.0f;
+            }
         }
         
         // 更新当前行为
@@ -332,95 +631,351 @@ public:
     }
     
     void selectBestBehavior() {
-        // 根据优先级选择最合适的行为
-        // 优先级：逃跑 > 狂暴 > 攻击 > 防御 > 追击 > 巡逻
-        
-        for (auto& behavior : availableBehaviors) {
-            if (behavior->canExecute(controlledEnemy)) {
-                std::string currentBehavior = controlledEnemy->getCurrentBehaviorName();
-                std::string newBehavior = behavior->getBehaviorName();
-                
-                // 只在需要时切换行为
-                if (currentBehavior != newBehavior) {
-                    // 创建新的行为实例
-                    if (newBehavior == "逃跑") {
-                        controlledEnemy->setBehavior(std::make_unique<FleeBehavior>());
-                        break;
-                    } else if (newBehavior == "狂暴") {
-                        controlledEnemy->setBehavior(std::make_unique<BerserkBehavior>());
-                        break;
-                    } else if (newBehavior == "攻击") {
-                        controlledEnemy->setBehavior(std::make_unique<AttackBehavior>());
-                        break;
-                    } else if (newBehavior == "防御") {
-                        controlledEnemy->setBehavior(std::make_unique<DefendBehavior>());
-                        break;
-                    } else if (newBehavior == "追击") {
-                        controlledEnemy->setBehavior(std::make_unique<ChaseBehavior>());
-                        break;
-                    }
-                }
-            }
+        // 难度行为和自定义行为自行决策，不替换
+        BehaviorId current = controlledEnemy->getCurrentBehaviorId();
+        if (!isTacticalBehavior(current)) {
+            return;
+        }
+        BehaviorId best = AIBehaviorRegistry::getInstance().selectBest(controlledEnemy);
+        // 只在需要时切换行为
+        if (best != BehaviorId::Count && best != current) {
+            controlledEnemy->setBehavior(best);
         }
     }
     
+    void setExternallyScheduled(bool scheduled) { externallyScheduled = scheduled; }
+    
+    float getBehaviorUpdateInterval() const { return behaviorUpdateInterval; }
+    AIEnemy* getControlledEnemy() const { return controlledEnemy; }
+    
     void setTarget(float x, float y) {
         controlledEnemy->setTarget(x, y);
     }
     
+    // 从多个候选目标中选取侦测范围内最近的一个
+    bool setTarget(const SpatialHashGrid& targets) {
+        return controlledEnemy->acquireTarget(targets);
+    }
+    
     void clearTarget() {
         controlledEnemy->clearTarget();
     }
     
+    void forceBehavior(BehaviorId id) {
+        controlledEnemy->setBehavior(id);
+    }
+    
     void forceBehavior(const std::string& behaviorName) {
         // 强制切换到指定行为
-        if (behaviorName == "巡逻") {
-            controlledEnemy->setBehavior(std::make_unique<PatrolBehavior>(
-                std::vector<std::pair<float, float>>{{0, 0}, {100, 0}, {100, 100}, {0, 100}}
-            ));
-        } else if (behaviorName == "追击") {
-            controlledEnemy->setBehavior(std::make_unique<ChaseBehavior>());
-        } else if (behaviorName == "攻击") {
-            controlledEnemy->setBehavior(std::make_unique<AttackBehavior>());
-        } else if (behaviorName == "逃跑") {
-            controlledEnemy->setBehavior(std::make_unique<FleeBehavior>());
-        } else if (behaviorName == "防御") {
-            controlledEnemy->setBehavior(std::make_unique<DefendBehavior>());
-        } else if (behaviorName == "狂暴") {
-            controlledEnemy->setBehavior(std::make_unique<BerserkBehavior>());
-        }
+        forceBehavior(AIBehaviorRegistry::getInstance().findByName(behaviorName));
     }
 };
 
-// 不同难度的AI策略
-class EasyAI : public AIBehavior {
+// AI调度统计
+struct AISchedulerStats {
+    uint64_t frames = 0;
+    uint64_t evaluations = 0;
+    uint64_t deferredEvaluations = 0;   // 因预算用尽推迟到后续帧的评估次数
+    uint64_t overBudgetFrames = 0;
+    double lastFrameMicros = 0.0;
+    double maxFrameMicros = 0.0;
+    double totalFrameMicros = 0.0;
+    size_t lastFrameEvaluations = 0;
+    size_t maxFrameEvaluations = 0;
+    
+    double getAverageFrameMicros() const {
+        return frames ? totalFrameMicros / static_cast<double>(frames) : 0.0;
+    }
+};
+
+// AI调度器 - 错开各控制器的行为评估时机，并限制每帧评估耗时
+// 注册时按黄金分割分配相位，同一帧创建的敌人不会在同一帧集中评估。
+// 到期的控制器分三档：等待过久的、靠近玩家的、其余的，按档依次评估，
+// 档内从轮转游标开始，预算用尽的顺延到下一帧；整个过程O(N)不排序
+class AIScheduler {
+private:
+    struct Entry {
+        StrategyAIController* controller;
+        float sinceEvaluation;
+        float interval;              // 缓存评估间隔，扫描时不访问控制器
+    };
+    
+    std::vector<Entry> entries;
+    std::vector<uint32_t> starving;
+    std::vector<uint32_t> nearby;
+    std::vector<uint32_t> distant;
+    size_t cursor = 0;
+    double budgetMicros;
+    float nearDistance = 300.0f;     // 到玩家距离在此以内的优先评估
+    float starvationFactor = 2.0f;   // 等待超过间隔的这么多倍视为饥饿，最先评估
+    AISchedulerStats stats;
+    
+    static constexpr size_t CLOCK_CHECK_INTERVAL = 8;
+    
 public:
-    void execute(AIEnemy* enemy, float deltaTime) override {
-        // 简单AI：只会巡逻，反应较慢
-        std::vector<std::pair<float, float>> waypoints = {{0, 0}, {50, 0}, {50, 50}, {0, 50}};
-        enemy->patrol(waypoints, deltaTime * 0.5f);  // 移动速度减半
+    explicit AIScheduler(double frameBudgetMicros = 500.0) : budgetMicros(frameBudgetMicros) {}
+    
+    void addController(StrategyAIController* controller) {
+        float interval = controller->getBehaviorUpdateInterval();
+        float phase = std::fmod(static_cast<float>(entries.size()) * 0.618034f, 1.0f);
+        entries.push_back({controller, phase * interval, interval});
+        controller->setExternallyScheduled(true);
     }
     
-    std::string getBehaviorName() const override { return "简单AI"; }
-    bool canExecute(AIEnemy* enemy) const override { return enemy->getHealth() > 0; }
+    void removeController(StrategyAIController* controller) {
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+            [controller](const Entry& e) { return e.controller == controller; }), entries.end());
+        controller->setExternallyScheduled(false);
+    }
+    
+    void clear() {
+        for (auto& e : entries) {
+            e.controller->setExternallyScheduled(false);
+        }
+        entries.clear();
+    }
+    
+    // distanceSqOf(controller)返回到最近玩家的距离平方
+    template <typename DistanceFn>
+    void runFrame(float deltaTime, DistanceFn&& distanceSqOf) {
+        auto start = std::chrono::steady_clock::now();
+        
+        starving.clear();
+        nearby.clear();
+        distant.clear();
+        size_t count = entries.size();
+        float nearSq = nearDistance * nearDistance;
+        for (size_t k = 0; k < count; ++k) {
+            uint32_t i = static_cast<uint32_t>((cursor + k) % count);
+            auto& e = entries[i];
+            e.sinceEvaluation += deltaTime;
+            if (e.sinceEvaluation < e.interval) {
+                continue;
+            }
+            if (e.sinceEvaluation >= e.interval * starvationFactor) {
+                starving.push_back(i);
+            } else if (distanceSqOf(e.controller) <= nearSq) {
+                nearby.push_back(i);
+            } else {
+                distant.push_back(i);
+            }
+        }
+        
+        // 预算只限制评估阶段；至少评估一个，保证在预算极小时也能推进
+        auto evaluationStart = std::chrono::steady_clock::now();
+        size_t evaluated = 0;
+        bool budgetExhausted = false;
+        for (auto* tier : {&starving, &nearby, &distant}) {
+            for (uint32_t i : *tier) {
+                if (evaluated > 0 && evaluated % CLOCK_CHECK_INTERVAL == 0) {
+                    double elapsed = std::chrono::duration<double, std::micro>(
+                        std::chrono::steady_clock::now() - evaluationStart).count();
+                    if (elapsed >= budgetMicros) {
+                        budgetExhausted = true;
+                        break;
+                    }
+                }
+                entries[i].controller->selectBestBehavior();
+                entries[i].sinceEvaluation = 0.0f;
+                evaluated++;
+            }
+            if (budgetExhausted) {
+                break;
+            }
+        }
+        cursor = count ? (cursor + evaluated) % count : 0;
+        
+        size_t due = starving.size() + nearby.size() + distant.size();
+        double frameMicros = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - start).count();
+        stats.frames++;
+        stats.evaluations += evaluated;
+        stats.deferredEvaluations += due - evaluated;
+        stats.lastFrameMicros = frameMicros;
+        stats.maxFrameMicros = std::max(stats.maxFrameMicros, frameMicros);
+        stats.totalFrameMicros += frameMicros;
+        stats.lastFrameEvaluations = evaluated;
+        stats.maxFrameEvaluations = std::max(stats.maxFrameEvaluations, evaluated);
+        if (frameMicros > budgetMicros) {
+            stats.overBudgetFrames++;
+        }
+    }
+    
+    void setNearDistance(float distance) { nearDistance = distance; }
+    
+    void setBudgetMicros(double micros) { budgetMicros = micros; }
+    double getBudgetMicros() const { return budgetMicros; }
+    
+    const AISchedulerStats& getStats() const { return stats; }
+    void resetStats() { stats = AISchedulerStats(); }
+    
+    size_t getControllerCount() const { return entries.size(); }
 };
 
-class HardAI : public AIBehavior {
+// 任务系统 - 每个工作线程一个双端队列，空闲时从其他队列窃取任务
+// 线程自己从队尾取（缓存热），窃取者从队首取（通常是更大、更早的块）
+class JobSystem {
 private:
-    StrategyAIController* controller;
+    struct Job {
+        void (*run)(void* context, size_t begin, size_t end);
+        void* context;
+        size_t begin, end;
+        std::atomic<size_t>* remaining;
+    };
+    
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+    
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<bool> running{true};
+    std::atomic<size_t> queuedJobs{0};
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    
+    static int& currentWorkerIndex() {
+        static thread_local int index = -1;
+        return index;
+    }
+    
+    void push(size_t queueIndex, const Job& job) {
+        {
+            std::lock_guard<std::mutex> lock(queues[queueIndex]->mutex);
+            queues[queueIndex]->jobs.push_back(job);
+        }
+        queuedJobs.fetch_add(1, std::memory_order_release);
+    }
+    
+    bool popLocal(size_t queueIndex, Job& job) {
+        auto& queue = *queues[queueIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty()) {
+            return false;
+        }
+        job = queue.jobs.back();
+        queue.jobs.pop_back();
+        return true;
+    }
+    
+    bool steal(size_t startIndex, Job& job) {
+        for (size_t i = 0; i < queues.size(); ++i) {
+            auto& queue = *queues[(startIndex + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.jobs.empty()) {
+                job = queue.jobs.front();
+                queue.jobs.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    bool findJob(Job& job) {
+        int self = currentWorkerIndex();
+        if (self >= 0 && popLocal(static_cast<size_t>(self), job)) {
+            queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        if (steal(self >= 0 ? static_cast<size_t>(self) + 1 : 0, job)) {
+            queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+    
+    static void execute(const Job& job) {
+        job.run(job.context, job.begin, job.end);
+        job.remaining->fetch_sub(1, std::memory_order_acq_rel);
+    }
+    
+    void workerLoop(int index) {
+        currentWorkerIndex() = index;
+        Job job;
+        while (running.load(std::memory_order_acquire)) {
+            if (findJob(job)) {
+                execute(job);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeCondition.wait(lock, [this] {
+                return !running.load(std::memory_order_acquire) ||
+                       queuedJobs.load(std::memory_order_acquire) > 0;
+            });
+        }
+    }
     
 public:
-    HardAI(StrategyAIController* ctrl) : controller(ctrl) {}
+    // 默认工作线程数 = 硬件线程数 - 1，调用线程在等待时也会执行任务
+    explicit JobSystem(size_t workerCount = std::max(1u, std::thread::hardware_concurrency()) - 1) {
+        for (size_t i = 0; i < workerCount; ++i) {
+            queues.push_back(std::make_unique<WorkerQueue>());
+        }
+        for (size_t i = 0; i < workerCount; ++i) {
+            workers.emplace_back(&JobSystem::workerLoop, this, static_cast<int>(i));
+        }
+    }
     
-    void execute(AIEnemy* enemy, float deltaTime) override {
-        // 困难AI：智能行为切换，快速反应
-        if (controller) {
-            controller->update(deltaTime * 1.5f);  // 更快的反应速度
+    ~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            running.store(false, std::memory_order_release);
+        }
+        wakeCondition.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
         }
     }
     
-    std::string getBehaviorName() const override { return "困难AI"; }
-    bool canExecute(AIEnemy* enemy) const override { return enemy->getHealth() > 0; }
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    
+    size_t getWorkerCount() const { return workers.size(); }
+    
+    // 把[0, count)切成grainSize大小的块并行执行body(begin, end)，返回时全部完成
+    // 可以在任务内部嵌套调用
+    template <typename Body>
+    void parallelFor(size_t count, size_t grainSize, const Body& body) {
+        if (count == 0) {
+            return;
+        }
+        grainSize = std::max<size_t>(1, grainSize);
+        size_t chunkCount = (count + grainSize - 1) / grainSize;
+        if (workers.empty() || chunkCount == 1) {
+            body(size_t(0), count);
+            return;
+        }
+        
+        std::atomic<size_t> remaining{chunkCount};
+        auto run = [](void* context, size_t begin, size_t end) {
+            (*static_cast<const Body*>(context))(begin, end);
+        };
+        
+        int self = currentWorkerIndex();
+        size_t firstQueue = self >= 0 ? static_cast<size_t>(self) : 0;
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            size_t begin = chunk * grainSize;
+            size_t end = std::min(count, begin + grainSize);
+            Job job{run, const_cast<Body*>(&body), begin, end, &remaining};
+            // 工作线程内嵌套调用时放进自己的队列，其余线程靠窃取分担
+            push(self >= 0 ? firstQueue : chunk % queues.size(), job);
+        }
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+        }
+        wakeCondition.notify_all();
+        
+        // 等待期间帮忙执行任务
+        Job job;
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            if (findJob(job)) {
+                execute(job);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
 };
 
 // 战斗管理器 - 展示策略模式的应用
@@ -428,6 +983,58 @@ class BattleManager {
 private:
     std::vector<std::unique_ptr<AIEnemy>> enemies;
     std::vector<std::unique_ptr<StrategyAIController>> aiControllers;
+    std::vector<size_t> lastAttackEvents;  // 上一帧发起攻击的敌人下标，按下标升序
+    SpatialHashGrid playerGrid;            // 多个玩家时的目标网格
+    SpatialHashGrid enemyGrid;             // 供敌人之间的范围查询，更新后首次查询时才重建
+    bool enemyGridDirty = true;
+    bool usePlayerGrid = false;
+    AIScheduler scheduler;
+    bool scheduledEvaluation = false;
+    
+    static constexpr size_t AI_CHUNK_SIZE = 64;
+    
+    // 用存活敌人的当前位置重建敌人网格
+    void rebuildEnemyGrid() {
+        enemyGrid.clear();
+        for (size_t i = 0; i < enemies.size(); ++i) {
+            if (enemies[i]->getHealth() > 0) {
+                enemyGrid.insert(static_cast<uint32_t>(i), enemies[i]->getX(), enemies[i]->getY());
+            }
+        }
+        enemyGrid.build();
+        enemyGridDirty = false;
+    }
+    
+    // 行为评估交给调度器，离玩家越近越优先
+    void runScheduler(float deltaTime) {
+        if (!scheduledEvaluation) {
+            return;
+        }
+        scheduler.runFrame(deltaTime, [](StrategyAIController* controller) {
+            AIEnemy* enemy = controller->getControlledEnemy();
+            return enemy->getHasTarget() ? enemy->getDistanceSqToTarget()
+                                         : std::numeric_limits<float>::max();
+        });
+    }
+    
+    void updateController(size_t index, float deltaTime) {
+        if (usePlayerGrid) {
+            aiControllers[index]->setTarget(playerGrid);
+        }
+        aiControllers[index]->update(deltaTime);
+    }
+    
+    // 跨敌人的效果按敌人下标顺序合并，结果与线程数和调度顺序无关
+    void mergeBattleEffects() {
+        enemyGridDirty = true;
+        lastAttackEvents.clear();
+        for (size_t i = 0; i < enemies.size(); ++i) {
+            int attacks = enemies[i]->consumePendingAttacks();
+            for (int a = 0; a < attacks; ++a) {
+                lastAttackEvents.push_back(i);
+            }
+        }
+    }
     
 public:
     void createEnemies(int count, const std::string& difficulty = "normal") {
@@ -438,30 +1045,91 @@ public:
             
             // 根据难度设置不同的AI策略
             if (difficulty == "easy") {
-                enemy->setBehavior(std::make_unique<EasyAI>());
+                enemy->setBehavior(BehaviorId::Easy);
             } else if (difficulty == "hard") {
-                enemy->setBehavior(std::make_unique<HardAI>(aiController.get()));
+                enemy->setBehavior(BehaviorId::Hard);
             }
             // normal难度使用默认的StrategyAIController逻辑
             
+            if (scheduledEvaluation) {
+                scheduler.addController(aiController.get());
+            }
             aiControllers.push_back(std::move(aiController));
             enemies.push_back(std::move(enemy));
         }
+        enemyGridDirty = true;
     }
     
     void updateBattle(float deltaTime) {
-        for (auto& controller : aiControllers) {
-            controller->update(deltaTime);
+        PROFILE_SUBSYSTEM(ProfileSubsystem::AI, "BattleManager::updateBattle");
+        runScheduler(deltaTime);
+        for (size_t i = 0; i < aiControllers.size(); ++i) {
+            updateController(i, deltaTime);
+        }
+        mergeBattleEffects();
+    }
+    
+    // 并行版本：每个控制器只读写自己的敌人，按块分给任务系统执行，之后串行合并
+    void updateBattle(float deltaTime, JobSystem& threadPool) {
+        PROFILE_SUBSYSTEM(ProfileSubsystem::AI, "BattleManager::updateBattle");
+        runScheduler(deltaTime);
+        threadPool.parallelFor(aiControllers.size(), AI_CHUNK_SIZE,
+            [this, deltaTime](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    updateController(i, deltaTime);
+                }
+            });
+        mergeBattleEffects();
+    }
+    
+    const std::vector<size_t>& getLastAttackEvents() const { return lastAttackEvents; }
+    
+    // 开启后行为评估由AIScheduler按预算错峰执行
+    void setScheduledEvaluation(bool enabled, double frameBudgetMicros = 500.0) {
+        if (enabled == scheduledEvaluation) {
+            scheduler.setBudgetMicros(frameBudgetMicros);
+            return;
+        }
+        scheduledEvaluation = enabled;
+        scheduler.clear();
+        scheduler.setBudgetMicros(frameBudgetMicros);
+        if (enabled) {
+            for (auto& controller : aiControllers) {
+                scheduler.addController(controller.get());
+            }
         }
     }
     
+    const AISchedulerStats& getSchedulerStats() const { return scheduler.getStats(); }
+    
     void setPlayerPosition(float x, float y) {
         // 让所有敌人以玩家为目标
+        usePlayerGrid = false;
         for (auto& controller : aiControllers) {
             controller->setTarget(x, y);
         }
     }
     
+    // 多个玩家：每帧更新前，每个敌人在侦测范围内选取最近的玩家
+    void setPlayerPositions(const std::vector<std::pair<float, float>>& positions) {
+        playerGrid.clear();
+        for (size_t i = 0; i < positions.size(); ++i) {
+            playerGrid.insert(static_cast<uint32_t>(i), positions[i].first, positions[i].second);
+        }
+        playerGrid.build();
+        usePlayerGrid = true;
+    }
+    
+    // 查询半径内存活的敌人（基于上一帧结束时的位置）；更新后的首次查询会先重建网格
+    void queryEnemiesInRange(float x, float y, float radius, std::vector<AIEnemy*>& out) {
+        if (enemyGridDirty) {
+            rebuildEnemyGrid();
+        }
+        enemyGrid.queryRadius(x, y, radius, [&](const SpatialHashGrid::Entry& e, float) {
+            out.push_back(enemies[e.id].get());
+        });
+    }
+    
     void printEnemyStates() const {
         for (const auto& enemy : enemies) {
             // printf("%s: %s (血量: %d/%d)\n", 
@@ -1,6 +1,8 @@
 #pragma once
 #include <memory>
 #include <string>
+#include <cstdint>
+#include "creational/factory_registry.h"
 
 /**
  * 抽象工厂模式 (Abstract Factory Pattern)
@@ -57,49 +59,78 @@ public:
     std::string getTheme() const override { return "Mac"; }
 };
 
+// 按主题注册的组件，两个注册表中同一主题的ID相同
+using ButtonRegistry = FactoryRegistry<Button, WindowsButton, MacButton>;
+using WindowRegistry = FactoryRegistry<Window, WindowsWindow, MacWindow>;
+
+enum class UITheme : uint8_t {
+    Windows = ButtonRegistry::idOf<WindowsButton>(),
+    Mac = ButtonRegistry::idOf<MacButton>(),
+    Count = ButtonRegistry::COUNT
+};
+
+static_assert(WindowRegistry::idOf<WindowsWindow>() == static_cast<size_t>(UITheme::Windows) &&
+              WindowRegistry::idOf<MacWindow>() == static_cast<size_t>(UITheme::Mac),
+              "按钮和窗口注册表的主题顺序必须一致");
+
+using ButtonHolder = ButtonRegistry::Holder;
+using WindowHolder = WindowRegistry::Holder;
+
 // 抽象工厂接口
+// 具体工厂只选择主题，组件都从注册表按主题ID创建
 class UIFactory {
+private:
+    UITheme theme;
+    
+protected:
+    explicit UIFactory(UITheme uiTheme) : theme(uiTheme) {}
+    
 public:
     virtual ~UIFactory() = default;
-    virtual std::unique_ptr<Button> createButton() = 0;
-    virtual std::unique_ptr<Window> createWindow() = 0;
+    
+    virtual std::unique_ptr<Button> createButton() {
+        return ButtonRegistry::create(theme);
+    }
+    
+    virtual std::unique_ptr<Window> createWindow() {
+        return WindowRegistry::create(theme);
+    }
+    
+    // 在内联缓冲区中创建组件，不经过堆
+    Button* createButton(ButtonHolder& holder) const {
+        return ButtonRegistry::emplace(theme, holder);
+    }
+    
+    Window* createWindow(WindowHolder& holder) const {
+        return WindowRegistry::emplace(theme, holder);
+    }
+    
+    UITheme getTheme() const { return theme; }
 };
 
 // 具体工厂 - Windows工厂
 class WindowsUIFactory : public UIFactory {
 public:
-    std::unique_ptr<Button> createButton() override {
-        return std::make_unique<WindowsButton>();
-    }
-    
-    std::unique_ptr<Window> createWindow() override {
-        return std::make_unique<WindowsWindow>();
-    }
+    WindowsUIFactory() : UIFactory(UITheme::Windows) {}
 };
 
 // 具体工厂 - Mac工厂
 class MacUIFactory : public UIFactory {
 public:
-    std::unique_ptr<Button> createButton() override {
-        return std::make_unique<MacButton>();
-    }
-    
-    std::unique_ptr<Window> createWindow() override {
-        return std::make_unique<MacWindow>();
-    }
+    MacUIFactory() : UIFactory(UITheme::Mac) {}
 };
 
 // 客户端类：游戏UI管理器
 class GameUI {
 private:
     std::unique_ptr<UIFactory> factory;
-    std::unique_ptr<Button> button;
-    std::unique_ptr<Window> window;
+    ButtonHolder button;
+    WindowHolder window;
     
 public:
     GameUI(std::unique_ptr<UIFactory> uiFactory) : factory(std::move(uiFactory)) {
-        button = factory->createButton();
-        window = factory->createWindow();
+        factory->createButton(button);
+        factory->createWindow(window);
     }
     
     void renderUI() {
@@ -2,6 +2,12 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <limits>
+#include <stdexcept>
 
 /**
  * 建造者模式 (Builder Pattern)
@@ -120,8 +126,171 @@ public:
     }
 };
 
+// 装备和技能名称的驻留表 - 相同名称只保存一份，角色之间共享16位ID
+// 进程级单例，内部加锁，可在多个线程中同时驻留和查询
+class CharacterItemRegistry {
+public:
+    using ItemId = uint16_t;
+    
+private:
+    mutable std::mutex mutex;
+    std::deque<std::string> names;   // deque追加时不移动已有元素，getName返回的引用一直有效
+    std::unordered_map<std::string, ItemId> ids;
+    
+    CharacterItemRegistry() = default;
+    
+public:
+    static CharacterItemRegistry& getInstance() {
+        static CharacterItemRegistry instance;
+        return instance;
+    }
+    
+    // ID空间用尽时抛出std::length_error，而不是回绕成已有名称的ID
+    ItemId intern(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = ids.find(name);
+        if (it != ids.end()) {
+            return it->second;
+        }
+        if (names.size() > std::numeric_limits<ItemId>::max()) {
+            throw std::length_error("CharacterItemRegistry: too many distinct item names");
+        }
+        ItemId id = static_cast<ItemId>(names.size());
+        names.push_back(name);
+        ids.emplace(name, id);
+        return id;
+    }
+    
+    const std::string& getName(ItemId id) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return names.at(id);
+    }
+    
+    size_t getItemCount() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return names.size();
+    }
+};
+
+// 角色原型 - 建造者产出的属性和驻留后的装备/技能ID，同一原型的角色共享它
+struct CharacterArchetype {
+    int health = 0;
+    int attack = 0;
+    int defense = 0;
+    std::vector<CharacterItemRegistry::ItemId> equipment;
+    std::vector<CharacterItemRegistry::ItemId> skills;
+    
+    // 用建造者的步骤构建一次，记录结果
+    static CharacterArchetype fromBuilder(CharacterBuilder& builder) {
+        builder.reset();
+        auto sample = builder.setBasicInfo("")
+                             .setAttributes()
+                             .addEquipment()
+                             .addSkills()
+                             .getCharacter();
+        builder.reset();
+        auto& registry = CharacterItemRegistry::getInstance();
+        CharacterArchetype archetype;
+        archetype.health = sample->getHealth();
+        archetype.attack = sample->getAttack();
+        archetype.defense = sample->getDefense();
+        for (const auto& item : sample->getEquipment()) {
+            archetype.equipment.push_back(registry.intern(item));
+        }
+        for (const auto& skill : sample->getSkills()) {
+            archetype.skills.push_back(registry.intern(skill));
+        }
+        return archetype;
+    }
+};
+
+// 批量建造的角色集合 - 角色连续存放，装备和技能通过原型共享
+class CharacterBatch {
+public:
+    struct Entry {
+        std::string name;
+        int health;
+        int attack;
+        int defense;
+        uint32_t archetype;   // archetypes中的下标
+    };
+    
+private:
+    std::vector<CharacterArchetype> archetypes;
+    std::vector<Entry> characters;
+    
+    friend class CharacterDirector;
+    
+    uint32_t addArchetype(const CharacterArchetype& archetype) {
+        archetypes.push_back(archetype);
+        return static_cast<uint32_t>(archetypes.size() - 1);
+    }
+    
+public:
+    void reserve(size_t count) { characters.reserve(count); }
+    void clear() {
+        characters.clear();
+        archetypes.clear();
+    }
+    
+    size_t size() const { return characters.size(); }
+    Entry& operator[](size_t index) { return characters[index]; }
+    const Entry& operator[](size_t index) const { return characters[index]; }
+    const std::vector<Entry>& getCharacters() const { return characters; }
+    
+    const std::vector<CharacterItemRegistry::ItemId>& getEquipment(size_t index) const {
+        return archetypes[characters[index].archetype].equipment;
+    }
+    
+    const std::vector<CharacterItemRegistry::ItemId>& getSkills(size_t index) const {
+        return archetypes[characters[index].archetype].skills;
+    }
+    
+    // 展开为独立的GameCharacter（兼容旧接口，会复制字符串）
+    std::unique_ptr<GameCharacter> toCharacter(size_t index) const {
+        const Entry& entry = characters[index];
+        auto& registry = CharacterItemRegistry::getInstance();
+        auto character = std::make_unique<GameCharacter>();
+        character->setName(entry.name);
+        character->setHealth(entry.health);
+        character->setAttack(entry.attack);
+        character->setDefense(entry.defense);
+        for (auto item : getEquipment(index)) {
+            character->addEquipment(registry.getName(item));
+        }
+        for (auto skill : getSkills(index)) {
+            character->addSkill(registry.getName(skill));
+        }
+        return character;
+    }
+};
+
+// 标准角色原型
+enum class CharacterClass : uint8_t {
+    Warrior,
+    Mage,
+    Count
+};
+
 // 指挥者 - 角色创建管理器
 class CharacterDirector {
+private:
+    std::unique_ptr<CharacterArchetype> standardArchetypes[static_cast<size_t>(CharacterClass::Count)];
+    
+    const CharacterArchetype& getStandardArchetype(CharacterClass characterClass) {
+        auto& cached = standardArchetypes[static_cast<size_t>(characterClass)];
+        if (!cached) {
+            if (characterClass == CharacterClass::Mage) {
+                MageBuilder builder;
+                cached = std::make_unique<CharacterArchetype>(CharacterArchetype::fromBuilder(builder));
+            } else {
+                WarriorBuilder builder;
+                cached = std::make_unique<CharacterArchetype>(CharacterArchetype::fromBuilder(builder));
+            }
+        }
+        return *cached;
+    }
+    
 public:
     // 创建标准战士
     std::unique_ptr<GameCharacter> createWarrior(const std::string& name) {
@@ -143,6 +312,46 @@ public:
                      .getCharacter();
     }
     
+    // 批量建造count个角色追加到out，一次性预留空间，同批角色共享一份原型
+    // names与count等长时逐个使用；否则循环使用names并追加序号（names为空时只有序号）
+    void buildN(size_t count, const CharacterArchetype& archetype,
+                const std::vector<std::string>& names, CharacterBatch& out) {
+        uint32_t archetypeIndex = out.addArchetype(archetype);
+        out.characters.reserve(out.characters.size() + count);
+        bool exactNames = names.size() == count;
+        for (size_t i = 0; i < count; ++i) {
+            CharacterBatch::Entry entry{std::string(), archetype.health, archetype.attack,
+                                        archetype.defense, archetypeIndex};
+            if (exactNames) {
+                entry.name = names[i];
+            } else {
+                if (!names.empty()) {
+                    entry.name = names[i % names.size()];
+                    entry.name += '_';
+                }
+                entry.name += std::to_string(i);
+            }
+            out.characters.push_back(std::move(entry));
+        }
+    }
+    
+    void buildN(size_t count, CharacterClass characterClass,
+                const std::vector<std::string>& names, CharacterBatch& out) {
+        buildN(count, getStandardArchetype(characterClass), names, out);
+    }
+    
+    // 自定义建造者：先运行一次建造步骤得到原型
+    void buildN(size_t count, CharacterBuilder& builder,
+                const std::vector<std::string>& names, CharacterBatch& out) {
+        buildN(count, CharacterArchetype::fromBuilder(builder), names, out);
+    }
+    
+    CharacterBatch buildN(size_t count, CharacterClass characterClass, const std::vector<std::string>& names) {
+        CharacterBatch batch;
+        buildN(count, characterClass, names, batch);
+        return batch;
+    }
+    
     // 创建自定义角色（演示链式调用）
     std::unique_ptr<GameCharacter> createCustomCharacter(CharacterBuilder& builder, const std::string& name) {
         return builder.setBasicInfo(name)
@@ -1,6 +1,9 @@
 #pragma once
 #include <memory>
 #include <string>
+#include <vector>
+#include <cstdint>
+#include "creational/factory_registry.h"
 
 /**
  * 工厂方法模式 (Factory Method Pattern)
@@ -45,13 +48,34 @@ public:
     std::string getType() const override { return "Dragon"; }
 };
 
+// 敌人类型注册表 - 顺序与EnemyTypeId一致
+using EnemyRegistry = FactoryRegistry<Enemy, Goblin, Dragon>;
+
+enum class EnemyTypeId : uint8_t {
+    Goblin = EnemyRegistry::idOf<Goblin>(),
+    Dragon = EnemyRegistry::idOf<Dragon>(),
+    Count = EnemyRegistry::COUNT
+};
+
+// 内联存放任意一种敌人，一批敌人放在一个vector里只需要一次分配
+using EnemyHolder = EnemyRegistry::Holder;
+
 // 敌人工厂基类
+// 具体工厂只声明自己生产的类型ID，创建走注册表，批量生成不调用虚函数
 class EnemyFactory {
+private:
+    EnemyTypeId typeId;
+    
+protected:
+    explicit EnemyFactory(EnemyTypeId enemyType) : typeId(enemyType) {}
+    
 public:
     virtual ~EnemyFactory() = default;
     
-    // 工厂方法：由子类实现具体的创建逻辑
-    virtual std::unique_ptr<Enemy> createEnemy() = 0;
+    // 工厂方法：由子类决定具体的创建逻辑
+    virtual std::unique_ptr<Enemy> createEnemy() {
+        return EnemyRegistry::create(typeId);
+    }
     
     // 模板方法：提供统一的敌人创建流程
     std::unique_ptr<Enemy> spawnEnemy() {
@@ -59,20 +83,32 @@ public:
         // 可以在这里添加通用的初始化逻辑
         return enemy;
     }
+    
+    // 在内联缓冲区中创建一个敌人
+    Enemy* spawnEnemyInPlace(EnemyHolder& holder) const {
+        return EnemyRegistry::emplace(typeId, holder);
+    }
+    
+    // 生成一波敌人，追加到wave末尾
+    void spawnWave(size_t count, std::vector<EnemyHolder>& wave) const {
+        size_t first = wave.size();
+        wave.resize(first + count);
+        for (size_t i = first; i < wave.size(); ++i) {
+            EnemyRegistry::emplace(typeId, wave[i]);
+        }
+    }
+    
+    EnemyTypeId getEnemyTypeId() const { return typeId; }
 };
 
 // 具体工厂 - 哥布林工厂
 class GoblinFactory : public EnemyFactory {
 public:
-    std::unique_ptr<Enemy> createEnemy() override {
-        return std::make_unique<Goblin>();
-    }
+    GoblinFactory() : EnemyFactory(EnemyTypeId::Goblin) {}
 };
 
 // 具体工厂 - 龙工厂
 class DragonFactory : public EnemyFactory {
 public:
-    std::unique_ptr<Enemy> createEnemy() override {
-        return std::make_unique<Dragon>();
-    }
+    DragonFactory() : EnemyFactory(EnemyTypeId::Dragon) {}
 };
\ No newline at end of file
@@ -0,0 +1,159 @@
+#pragma once
+#include <memory>
+#include <new>
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+/**
+ * 编译期工厂注册表
+ * 产品类型作为模板参数在编译期注册，类型ID就是它在参数列表中的位置，
+ * 按ID创建是一次函数指针表下标，不需要工厂对象的虚函数或字符串比较。
+ * 产品可以创建在调用者提供的内存或内联小缓冲区(InPlaceObject)里，不经过堆
+ */
+
+// 内联持有一个Base派生对象的小缓冲区，可移动，放进vector后一次分配容纳整批对象
+template<typename Base, size_t Capacity, size_t Alignment = alignof(std::max_align_t)>
+class InPlaceObject {
+private:
+    alignas(Alignment) unsigned char buffer[Capacity];
+    Base* object = nullptr;
+    Base* (*relocate)(void* destination, Base* source) = nullptr;   // 移动构造到新位置并析构原对象
+    
+    template<typename T>
+    static Base* relocateAs(void* destination, Base* source) {
+        T* typed = static_cast<T*>(source);
+        Base* moved = new (destination) T(std::move(*typed));
+        typed->~T();
+        return moved;
+    }
+    
+    void moveFrom(InPlaceObject& other) {
+        if (other.object) {
+            object = other.relocate(buffer, other.object);
+            relocate = other.relocate;
+            other.object = nullptr;
+        }
+    }
+
+public:
+    InPlaceObject() = default;
+    ~InPlaceObject() { reset(); }
+    
+    InPlaceObject(InPlaceObject&& other) noexcept { moveFrom(other); }
+    
+    InPlaceObject& operator=(InPlaceObject&& other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+    
+    InPlaceObject(const InPlaceObject&) = delete;
+    InPlaceObject& operator=(const InPlaceObject&) = delete;
+    
+    template<typename T, typename... Args>
+    T& emplace(Args&&... args) {
+        static_assert(std::is_base_of<Base, T>::value, "产品必须派生自Base");
+        static_assert(sizeof(T) <= Capacity && Alignment % alignof(T) == 0, "产品放不进内联缓冲区");
+        reset();
+        T* created = new (buffer) T(std::forward<Args>(args)...);
+        object = created;
+        relocate = &relocateAs<T>;
+        return *created;
+    }
+    
+    void reset() {
+        if (object) {
+            object->~Base();
+            object = nullptr;
+        }
+    }
+    
+    Base* get() const { return object; }
+    Base* operator->() const { return object; }
+    Base& operator*() const { return *object; }
+    explicit operator bool() const { return object != nullptr; }
+};
+
+template<typename Base, typename... Products>
+class FactoryRegistry {
+public:
+    static constexpr size_t COUNT = sizeof...(Products);
+    static constexpr size_t INVALID_ID = COUNT;
+    
+    // 能容纳任何一种产品的存储大小和对齐
+    static constexpr size_t MAX_SIZE = std::max({sizeof(Products)...});
+    static constexpr size_t MAX_ALIGN = std::max({alignof(Products)...});
+    
+    using Holder = InPlaceObject<Base, MAX_SIZE, MAX_ALIGN>;
+    
+    static_assert(COUNT > 0, "注册表至少需要一种产品");
+    static_assert(std::conjunction<std::is_base_of<Base, Products>...>::value, "产品必须派生自Base");
+    static_assert(std::has_virtual_destructor<Base>::value, "Base需要虚析构函数");
+
+private:
+    template<typename T>
+    static Base* constructAt(void* storage) { return new (storage) T(); }
+    
+    template<typename T>
+    static std::unique_ptr<Base> createAs() { return std::make_unique<T>(); }
+    
+    template<typename T>
+    static Base* emplaceAs(Holder& holder) { return &holder.template emplace<T>(); }
+    
+    static constexpr Base* (*CONSTRUCTORS[COUNT])(void*) = {&constructAt<Products>...};
+    static constexpr std::unique_ptr<Base> (*CREATORS[COUNT])() = {&createAs<Products>...};
+    static constexpr Base* (*EMPLACERS[COUNT])(Holder&) = {&emplaceAs<Products>...};
+    
+    template<typename T, size_t Index, typename First, typename... Rest>
+    static constexpr size_t findId() {
+        if constexpr (std::is_same<T, First>::value) {
+            return Index;
+        } else if constexpr (sizeof...(Rest) == 0) {
+            return INVALID_ID;
+        } else {
+            return findId<T, Index + 1, Rest...>();
+        }
+    }
+    
+    template<typename Id>
+    static constexpr size_t toIndex(Id id) { return static_cast<size_t>(id); }
+
+public:
+    // 产品类型的编译期ID
+    template<typename T>
+    static constexpr size_t idOf() {
+        constexpr size_t id = findId<T, 0, Products...>();
+        static_assert(id != INVALID_ID, "类型没有注册");
+        return id;
+    }
+    
+    template<typename Id>
+    static constexpr bool isValid(Id id) { return toIndex(id) < COUNT; }
+    
+    // 堆上创建（兼容返回unique_ptr的接口）
+    template<typename Id>
+    static std::unique_ptr<Base> create(Id id) {
+        return isValid(id) ? CREATORS[toIndex(id)]() : nullptr;
+    }
+    
+    // 在调用者提供的存储中构造，存储至少MAX_SIZE字节并按MAX_ALIGN对齐；
+    // 调用者负责之后调用虚析构函数
+    template<typename Id>
+    static Base* construct(Id id, void* storage) {
+        return isValid(id) ? CONSTRUCTORS[toIndex(id)](storage) : nullptr;
+    }
+    
+    // 在内联缓冲区中构造，ID无效时清空holder并返回nullptr
+    template<typename Id>
+    static Base* emplace(Id id, Holder& holder) {
+        if (!isValid(id)) {
+            holder.reset();
+            return nullptr;
+        }
+        return EMPLACERS[toIndex(id)](holder);
+    }
+};
@@ -2,6 +2,10 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <unordered_map>
+#include <new>
+#include <cstddef>
+#include <cstdint>
 
 /**
  * 原型模式 (Prototype Pattern)
@@ -9,14 +13,26 @@
  * 特点：通过复制现有实例来创建新实例，而不是通过构造函数
  */
 
+// 游戏对象类型ID - 用于O(1)查找原型和对象池
+enum class GameObjectType : uint8_t {
+    Unknown,
+    Bullet,
+    Enemy,
+    Count
+};
+
+constexpr size_t GAME_OBJECT_TYPE_COUNT = static_cast<size_t>(GameObjectType::Count);
+
 // 游戏对象抽象基类
 class GameObject {
 protected:
     float x, y;  // 位置
     std::string type;
+    GameObjectType typeId;
     
 public:
-    GameObject(float posX = 0, float posY = 0) : x(posX), y(posY) {}
+    GameObject(float posX = 0, float posY = 0, GameObjectType id = GameObjectType::Unknown) 
+        : x(posX), y(posY), typeId(id) {}
     virtual ~GameObject() = default;
     
     // 原型模式的核心：克隆方法
@@ -31,6 +47,7 @@ public:
     float getY() const { return y; }
     void setPosition(float posX, float posY) { x = posX; y = posY; }
     std::string getType() const { return type; }
+    GameObjectType getTypeId() const { return typeId; }
 };
 
 // 具体原型 - 子弹类
@@ -42,7 +59,7 @@ private:
     
 public:
     Bullet(float posX = 0, float posY = 0, float velX = 10, float velY = 0, int dmg = 25, const std::string& bType = "普通子弹")
-        : GameObject(posX, posY), velocityX(velX), velocityY(velY), damage(dmg), bulletType(bType) {
+        : GameObject(posX, posY, GameObjectType::Bullet), velocityX(velX), velocityY(velY), damage(dmg), bulletType(bType) {
         type = "Bullet";
     }
     
@@ -76,7 +93,7 @@ private:
     
 public:
     EnemyUnit(float posX = 0, float posY = 0, int hp = 100, int attack = 20, float spd = 2.0f, const std::string& eType = "哥布林")
-        : GameObject(posX, posY), health(hp), attackPower(attack), speed(spd), enemyType(eType) {
+        : GameObject(posX, posY, GameObjectType::Enemy), health(hp), attackPower(attack), speed(spd), enemyType(eType) {
         type = "Enemy";
     }
     
@@ -100,24 +117,35 @@ public:
 };
 
 // 原型管理器 - 管理常用的原型对象
+// 每种类型ID对应第一个注册的原型，按ID查找是数组下标，按名字查找是一次哈希
 class PrototypeManager {
 private:
     std::vector<std::unique_ptr<GameObject>> prototypes;
+    GameObject* prototypesById[GAME_OBJECT_TYPE_COUNT] = {};
+    std::unordered_map<std::string, GameObject*> prototypesByName;
     
 public:
     // 注册原型对象
     void registerPrototype(std::unique_ptr<GameObject> prototype) {
+        GameObject* raw = prototype.get();
+        size_t id = static_cast<size_t>(raw->getTypeId());
+        if (id < GAME_OBJECT_TYPE_COUNT && !prototypesById[id]) {
+            prototypesById[id] = raw;
+        }
+        prototypesByName.emplace(raw->getType(), raw);
         prototypes.push_back(std::move(prototype));
     }
     
+    // 根据类型ID克隆对象
+    std::unique_ptr<GameObject> createObject(GameObjectType typeId) const {
+        const GameObject* prototype = getPrototype(typeId);
+        return prototype ? prototype->clone() : nullptr;
+    }
+    
     // 根据类型克隆对象
-    std::unique_ptr<GameObject> createObject(const std::string& type) {
-        for (const auto& prototype : prototypes) {
-            if (prototype->getType() == type) {
-                return prototype->clone();
-            }
-        }
-        return nullptr;
+    std::unique_ptr<GameObject> createObject(const std::string& type) const {
+        auto it = prototypesByName.find(type);
+        return it != prototypesByName.end() ? it->second->clone() : nullptr;
     }
     
     // 克隆指定索引的原型
@@ -128,48 +156,185 @@ public:
         return nullptr;
     }
     
+    const GameObject* getPrototype(GameObjectType typeId) const {
+        size_t id = static_cast<size_t>(typeId);
+        return id < GAME_OBJECT_TYPE_COUNT ? prototypesById[id] : nullptr;
+    }
+    
     size_t getPrototypeCount() const { return prototypes.size(); }
 };
 
+// 类型化对象池 - 按块(slab)分配槽位，释放的槽位进入空闲链表
+// 对象只在槽位第一次使用时从原型拷贝构造，之后复用时直接拷贝赋值重置状态，
+// 既没有堆分配也没有虚函数clone()。活跃对象记录在紧凑数组里，释放时交换删除
+template<typename T, size_t SLAB_SIZE = 256>
+class ObjectPool {
+private:
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)];   // 必须是第一个成员，T*可以直接转回Slot*
+        Slot* nextFree;
+        uint32_t activeIndex;
+        bool constructed;
+    };
+    
+    T prototype;
+    std::vector<std::unique_ptr<Slot[]>> slabs;
+    Slot* freeList = nullptr;
+    std::vector<T*> active;
+    
+    static T* objectOf(Slot* slot) {
+        return std::launder(reinterpret_cast<T*>(slot->storage));
+    }
+    
+    static Slot* slotOf(T* object) {
+        return reinterpret_cast<Slot*>(object);
+    }
+    
+    void addSlab() {
+        std::unique_ptr<Slot[]> slab(new Slot[SLAB_SIZE]);
+        for (size_t i = SLAB_SIZE; i-- > 0;) {
+            slab[i].nextFree = freeList;
+            slab[i].constructed = false;
+            freeList = &slab[i];
+        }
+        slabs.push_back(std::move(slab));
+    }
+    
+public:
+    explicit ObjectPool(const T& prototypeObject = T(), size_t initialCapacity = 0) 
+        : prototype(prototypeObject) {
+        reserve(initialCapacity);
+    }
+    
+    ~ObjectPool() {
+        for (auto& slab : slabs) {
+            for (size_t i = 0; i < SLAB_SIZE; ++i) {
+                if (slab[i].constructed) {
+                    objectOf(&slab[i])->~T();
+                }
+            }
+        }
+    }
+    
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+    
+    // 预分配至少capacity个槽位
+    void reserve(size_t capacity) {
+        while (getCapacity() < capacity) {
+            addSlab();
+        }
+    }
+    
+    // 取出一个与原型状态相同的对象
+    T* acquire() {
+        if (!freeList) {
+            addSlab();
+        }
+        Slot* slot = freeList;
+        freeList = slot->nextFree;
+        T* object = objectOf(slot);
+        if (slot->constructed) {
+            *object = prototype;
+        } else {
+            new (slot->storage) T(prototype);
+            slot->constructed = true;
+        }
+        slot->activeIndex = static_cast<uint32_t>(active.size());
+        active.push_back(object);
+        return object;
+    }
+    
+    // 归还对象，对象保持构造状态等待下次复用
+    void release(T* object) {
+        Slot* slot = slotOf(object);
+        T* last = active.back();
+        active[slot->activeIndex] = last;
+        slotOf(last)->activeIndex = slot->activeIndex;
+        active.pop_back();
+        slot->nextFree = freeList;
+        freeList = slot;
+    }
+    
+    // 归还所有满足条件的对象
+    template<typename Predicate>
+    size_t releaseIf(Predicate predicate) {
+        size_t released = 0;
+        for (size_t i = active.size(); i-- > 0;) {
+            if (predicate(*active[i])) {
+                release(active[i]);
+                released++;
+            }
+        }
+        return released;
+    }
+    
+    void releaseAll() {
+        while (!active.empty()) {
+            release(active.back());
+        }
+    }
+    
+    template<typename Function>
+    void forEachActive(Function function) {
+        for (T* object : active) {
+            function(*object);
+        }
+    }
+    
+    void setPrototype(const T& prototypeObject) { prototype = prototypeObject; }
+    const T& getPrototype() const { return prototype; }
+    
+    size_t getActiveCount() const { return active.size(); }
+    size_t getCapacity() const { return slabs.size() * SLAB_SIZE; }
+};
+
 // 游戏对象池 - 使用原型模式优化对象创建
+// 子弹是创建销毁最频繁的对象，用较大的块减少扩容次数
 class GameObjectPool {
 private:
-    std::unique_ptr<GameObject> bulletPrototype;
-    std::unique_ptr<GameObject> enemyPrototype;
-    std::vector<std::unique_ptr<GameObject>> activeBullets;
-    std::vector<std::unique_ptr<GameObject>> activeEnemies;
+    ObjectPool<Bullet, 1024> bullets;
+    ObjectPool<EnemyUnit> enemies;
     
 public:
-    GameObjectPool() {
-        // 初始化原型对象
-        bulletPrototype = std::make_unique<Bullet>(0, 0, 15, 0, 30, "快速子弹");
-        enemyPrototype = std::make_unique<EnemyUnit>(0, 0, 80, 25, 1.5f, "强化哥布林");
-    }
+    GameObjectPool(size_t bulletCapacity = 1024, size_t enemyCapacity = 0)
+        : bullets(Bullet(0, 0, 15, 0, 30, "快速子弹"), bulletCapacity),
+          enemies(EnemyUnit(0, 0, 80, 25, 1.5f, "强化哥布林"), enemyCapacity) {}
     
-    // 创建子弹（通过克隆原型）
-    void spawnBullet(float x, float y) {
-        auto bullet = bulletPrototype->clone();
+    // 创建子弹（从原型拷贝状态到复用的槽位）
+    Bullet* spawnBullet(float x, float y) {
+        Bullet* bullet = bullets.acquire();
         bullet->setPosition(x, y);
-        activeBullets.push_back(std::move(bullet));
+        return bullet;
     }
     
-    // 创建敌人（通过克隆原型）
-    void spawnEnemy(float x, float y) {
-        auto enemy = enemyPrototype->clone();
+    // 创建敌人（从原型拷贝状态到复用的槽位）
+    EnemyUnit* spawnEnemy(float x, float y) {
+        EnemyUnit* enemy = enemies.acquire();
         enemy->setPosition(x, y);
-        activeEnemies.push_back(std::move(enemy));
+        return enemy;
     }
     
-    // 更新所有活跃对象
+    void despawnBullet(Bullet* bullet) { bullets.release(bullet); }
+    void despawnEnemy(EnemyUnit* enemy) { enemies.release(enemy); }
+    
+    // 回收飞出区域的子弹
+    size_t despawnBulletsOutside(float minX, float minY, float maxX, float maxY) {
+        return bullets.releaseIf([=](const Bullet& bullet) {
+            return bullet.getX() < minX || bullet.getX() > maxX ||
+                   bullet.getY() < minY || bullet.getY() > maxY;
+        });
+    }
+    
+    // 更新所有活跃对象（类型已知，直接调用不经过虚函数表）
     void updateAll() {
-        for (auto& bullet : activeBullets) {
-            bullet->update();
-        }
-        for (auto& enemy : activeEnemies) {
-            enemy->update();
-        }
+        bullets.forEachActive([](Bullet& bullet) { bullet.Bullet::update(); });
+        enemies.forEachActive([](EnemyUnit& enemy) { enemy.EnemyUnit::update(); });
     }
     
-    size_t getBulletCount() const { return activeBullets.size(); }
-    size_t getEnemyCount() const { return activeEnemies.size(); }
-};
\ No newline at end of file
+    ObjectPool<Bullet, 1024>& getBulletPool() { return bullets; }
+    ObjectPool<EnemyUnit>& getEnemyPool() { return enemies; }
+    
+    size_t getBulletCount() const { return bullets.getActiveCount(); }
+    size_t getEnemyCount() const { return enemies.getActiveCount(); }
+};
@@ -1,43 +1,98 @@
 #pragma once
-#include <memory>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 
 /**
  * 单例模式 (Singleton Pattern)
  * 游戏开发中常用于：游戏管理器、资源管理器、配置管理器等全局唯一的对象
  * 特点：确保一个类只有一个实例，并提供全局访问点
  */
+
+// C++20起由编译器检查常量初始化，C++17下依靠constexpr构造函数保证
+#if __cplusplus >= 202002L
+#define PATTERN_CONSTINIT constinit
+#else
+#define PATTERN_CONSTINIT
+#endif
+
+// 按线程分片的计数器 - 每个线程固定写自己的缓存行，读取时汇总所有分片
+// 汇总值不是瞬时快照：并发累加期间读到的是某个中间结果
+class ShardedCounter {
+public:
+    static constexpr size_t SHARD_COUNT = 32;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<int64_t> value{0};
+    };
+    
+    Shard shards[SHARD_COUNT];
+    
+    // 线程第一次使用时轮流分配分片
+    static size_t shardIndex() {
+        static std::atomic<size_t> nextShard{0};
+        thread_local size_t index = nextShard.fetch_add(1, std::memory_order_relaxed) % SHARD_COUNT;
+        return index;
+    }
+
+public:
+    constexpr ShardedCounter() = default;
+    
+    void add(int64_t amount) {
+        shards[shardIndex()].value.fetch_add(amount, std::memory_order_relaxed);
+    }
+    
+    int64_t load() const {
+        int64_t total = 0;
+        for (const auto& shard : shards) {
+            total += shard.value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+    
+    // 与并发的add()同时调用时，正在进行的累加可能保留也可能被清掉
+    void reset() {
+        for (auto& shard : shards) {
+            shard.value.store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+// 游戏管理器 - 常量初始化的单例
+// 实例是静态存储期对象，构造函数为constexpr，在任何代码运行前完成初始化，
+// getInstance()没有判空和加锁；析构为平凡析构，程序退出时也没有销毁顺序问题
 class GameManager {
 private:
-    static std::unique_ptr<GameManager> instance;  // 唯一实例
+    static GameManager instance;  // 唯一实例
     
     // 私有构造函数，防止外部创建实例
-    GameManager() : isGameRunning(false), score(0) {}
+    constexpr GameManager() = default;
     
-    bool isGameRunning;
-    int score;
+    std::atomic<bool> isGameRunning{false};
+    ShardedCounter score;
 
 public:
     // 删除拷贝构造函数和赋值操作符，确保单例特性
     GameManager(const GameManager&) = delete;
     GameManager& operator=(const GameManager&) = delete;
     
-    // 获取单例实例的静态方法
+    // 获取单例实例的静态方法，任意线程可调用
     static GameManager& getInstance() {
-        if (!instance) {
-            instance = std::unique_ptr<GameManager>(new GameManager());
-        }
-        return *instance;
+        return instance;
     }
     
     // 游戏管理相关方法
-    void startGame() { isGameRunning = true; }
-    void endGame() { isGameRunning = false; }
-    bool isRunning() const { return isGameRunning; }
+    void startGame() { isGameRunning.store(true, std::memory_order_release); }
+    void endGame() { isGameRunning.store(false, std::memory_order_release); }
+    bool isRunning() const { return isGameRunning.load(std::memory_order_acquire); }
     
-    void addScore(int points) { score += points; }
-    int getScore() const { return score; }
-    void resetScore() { score = 0; }
+    // 可在任意工作线程上调用，只写当前线程的分片
+    void addScore(int points) { score.add(points); }
+    int getScore() const { return static_cast<int>(score.load()); }
+    int64_t getScoreTotal() const { return score.load(); }
+    void resetScore() { score.reset(); }
 };
 
-// 静态成员定义
-std::unique_ptr<GameManager> GameManager::instance = nullptr;
\ No newline at end of file
+// 静态成员定义（inline变量，多个翻译单元包含时只有一份）
+PATTERN_CONSTINIT inline GameManager GameManager::instance;
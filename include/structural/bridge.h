@@ -1,6 +1,9 @@
 #pragma once
 #include <memory>
 #include <string>
+#include <vector>
+#include <algorithm>
+#include "structural/flyweight.h"
 
 /**
  * 桥接模式 (Bridge Pattern)
@@ -10,12 +13,30 @@
 
 // 实现接口 - 渲染器实现
 class RenderImplementation {
+protected:
+    size_t drawCallCount = 0;  // 本帧提交的绘制调用数
+    
 public:
     virtual ~RenderImplementation() = default;
     virtual void renderSprite(float x, float y, const std::string& texture) = 0;
     virtual void renderText(float x, float y, const std::string& text) = 0;
     virtual void clearScreen() = 0;
     virtual void present() = 0;
+    
+    // 批量提交同一纹理的精灵实例，默认逐个回退到renderSprite
+    virtual void submitSprites(TextureHandle texture, const SpriteInstance* instances, size_t count) {
+        SpriteTexture* resolved = TextureManager::getInstance().resolve(texture);
+        if (!resolved) {
+            return;
+        }
+        const std::string name = resolved->getTextureName();
+        for (size_t i = 0; i < count; ++i) {
+            renderSprite(instances[i].x, instances[i].y, name);
+        }
+    }
+    
+    size_t getDrawCallCount() const { return drawCallCount; }
+    void resetDrawCallCount() { drawCallCount = 0; }
 };
 
 // 具体实现 - OpenGL渲染器
@@ -24,6 +45,15 @@ public:
     void renderSprite(float x, float y, const std::string& texture) override {
         // OpenGL精灵渲染实现
         // glBindTexture, glDrawArrays等OpenGL调用
+        ++drawCallCount;
+    }
+    
+    void submitSprites(TextureHandle texture, const SpriteInstance* instances, size_t count) override {
+        // 上传实例缓冲区后一次实例化绘制
+        // glBindTexture; glBufferSubData(instances, count); glDrawArraysInstanced(..., count)
+        if (count > 0) {
+            ++drawCallCount;
+        }
     }
     
     void renderText(float x, float y, const std::string& text) override {
@@ -45,6 +75,15 @@ public:
     void renderSprite(float x, float y, const std::string& texture) override {
         // DirectX精灵渲染实现
         // D3D11相关调用
+        ++drawCallCount;
+    }
+    
+    void submitSprites(TextureHandle texture, const SpriteInstance* instances, size_t count) override {
+        // 更新实例缓冲区后一次实例化绘制
+        // PSSetShaderResources; Map/Unmap(instances, count); DrawIndexedInstanced(6, count, ...)
+        if (count > 0) {
+            ++drawCallCount;
+        }
     }
     
     void renderText(float x, float y, const std::string& text) override {
@@ -64,6 +103,7 @@ public:
 class GameRenderer {
 protected:
     std::unique_ptr<RenderImplementation> implementation;
+    std::vector<SpriteInstance> spriteQueue;  // 本帧待批量绘制的精灵，跨帧复用容量
     
 public:
     GameRenderer(std::unique_ptr<RenderImplementation> impl) 
@@ -73,6 +113,7 @@ public:
     
     // 基本渲染操作
     virtual void beginFrame() {
+        implementation->resetDrawCallCount();
         implementation->clearScreen();
     }
     
@@ -80,6 +121,35 @@ public:
         implementation->present();
     }
     
+    // 批量绘制：按(层, 纹理)排序后每个纹理一次提交，实例坐标为屏幕空间
+    void drawSprites(std::vector<SpriteInstance>& sprites) {
+        std::sort(sprites.begin(), sprites.end(),
+            [](const SpriteInstance& a, const SpriteInstance& b) {
+                if (a.layer != b.layer) {
+                    return a.layer < b.layer;
+                }
+                return a.texture.getValue() < b.texture.getValue();
+            });
+        
+        size_t begin = 0;
+        while (begin < sprites.size()) {
+            size_t end = begin + 1;
+            while (end < sprites.size() && sprites[end].texture == sprites[begin].texture &&
+                   sprites[end].layer == sprites[begin].layer) {
+                ++end;
+            }
+            implementation->submitSprites(sprites[begin].texture, &sprites[begin], end - begin);
+            begin = end;
+        }
+    }
+    
+    // 将精灵加入本帧批量队列，在render()中统一排序提交
+    void queueSprite(const SpriteInstance& sprite) {
+        spriteQueue.push_back(sprite);
+    }
+    
+    size_t getDrawCallCount() const { return implementation->getDrawCallCount(); }
+    
     // 可以添加更高级的渲染方法
     virtual void render() = 0;
 };
@@ -88,10 +158,11 @@ public:
 class Game2DRenderer : public GameRenderer {
 private:
     float cameraX, cameraY;
+    const GameWorld* world;
     
 public:
     Game2DRenderer(std::unique_ptr<RenderImplementation> impl) 
-        : GameRenderer(std::move(impl)), cameraX(0), cameraY(0) {}
+        : GameRenderer(std::move(impl)), cameraX(0), cameraY(0), world(nullptr) {}
     
     void render() override {
         beginFrame();
@@ -114,13 +185,23 @@ public:
         cameraY = y;
     }
     
+    // 设置要绘制的游戏世界（瓦片、粒子、敌人经批量接口提交）
+    void setWorld(const GameWorld* gameWorld) {
+        world = gameWorld;
+    }
+    
 private:
     void renderBackground() {
         implementation->renderSprite(0, 0, "background.png");
     }
     
     void renderSprites() {
-        // 渲染游戏中的精灵
+        // 渲染游戏中的精灵：收集后按纹理合批
+        if (world) {
+            world->render(cameraX, cameraY, spriteQueue);
+        }
+        drawSprites(spriteQueue);
+        spriteQueue.clear();
     }
     
     void renderUI() {
@@ -160,7 +241,9 @@ private:
     }
     
     void renderScene() {
-        // 渲染3D场景
+        // 渲染3D场景，公告板精灵按纹理合批
+        drawSprites(spriteQueue);
+        spriteQueue.clear();
     }
     
     void renderHUD() {
@@ -3,6 +3,7 @@
 #include <memory>
 #include <string>
 #include <algorithm>
+#include <cstdint>
 
 /**
  * 组合模式 (Composite Pattern)
@@ -10,6 +11,8 @@
  * 特点：将对象组合成树形结构，使客户端对单个对象和组合对象的使用具有一致性
  */
 
+class FlatSceneGraph;
+
 // 组件接口 - 游戏对象基类
 class GameObjectComponent {
 protected:
@@ -17,6 +20,12 @@ protected:
     float x, y;  // 相对位置
     bool visible;
     
+    // 所属的扁平场景图及节点下标，位置和可见性变化时通知它
+    FlatSceneGraph* sceneGraph = nullptr;
+    uint32_t sceneNode = 0;
+    
+    friend class FlatSceneGraph;
+    
 public:
     GameObjectComponent(const std::string& objectName, float posX = 0, float posY = 0) 
         : name(objectName), x(posX), y(posY), visible(true) {}
@@ -42,12 +51,18 @@ public:
     
     virtual size_t getChildCount() const { return 0; }
     
+    // 只更新自身，不递归子对象；扁平场景图按深度优先顺序逐个调用
+    virtual void updateSelf(float deltaTime) { update(deltaTime); }
+    
+    // 脱离扁平场景图（组合节点连同子树一起）
+    virtual void detachFromSceneGraph() { sceneGraph = nullptr; }
+    
     // 基本属性访问
     const std::string& getName() const { return name; }
-    void setPosition(float posX, float posY) { x = posX; y = posY; }
+    inline void setPosition(float posX, float posY);  // 在FlatSceneGraph之后实现
     float getX() const { return x; }
     float getY() const { return y; }
-    void setVisible(bool vis) { visible = vis; }
+    inline void setVisible(bool vis);
     bool isVisible() const { return visible; }
 };
 
@@ -120,8 +135,22 @@ private:
 public:
     GameObjectGroup(const std::string& name) : GameObjectComponent(name) {}
     
+    // 组合节点自身的更新逻辑写在updateGroup中，update()只负责递归。
+    // 扁平场景图对组合节点只调用updateGroup，子对象由它各自调用
+    virtual void updateGroup(float deltaTime) { (void)deltaTime; }
+    
+    void updateSelf(float deltaTime) override { updateGroup(deltaTime); }
+    
+    void detachFromSceneGraph() override {
+        sceneGraph = nullptr;
+        for (auto& child : children) {
+            child->detachFromSceneGraph();
+        }
+    }
+    
     void update(float deltaTime) override {
-        // 更新所有子对象
+        // 先更新自身，再更新所有子对象，与扁平场景图的深度优先顺序一致
+        updateGroup(deltaTime);
         for (auto& child : children) {
             child->update(deltaTime);
         }
@@ -140,18 +169,8 @@ public:
     }
     
     // 组合对象特有的操作
-    void addChild(std::shared_ptr<GameObjectComponent> child) override {
-        if (child) {
-            children.push_back(child);
-        }
-    }
-    
-    void removeChild(std::shared_ptr<GameObjectComponent> child) override {
-        children.erase(
-            std::remove(children.begin(), children.end(), child),
-            children.end()
-        );
-    }
+    inline void addChild(std::shared_ptr<GameObjectComponent> child) override;
+    inline void removeChild(std::shared_ptr<GameObjectComponent> child) override;
     
     std::shared_ptr<GameObjectComponent> getChild(size_t index) override {
         if (index < children.size()) {
@@ -175,11 +194,242 @@ public:
     }
     
     // 清空所有子对象
-    void clear() {
-        children.clear();
+    inline void clear();
+};
+
+// 扁平场景图 - 把组件树按深度优先顺序展开到连续数组
+// 子树在数组中是连续区间[i, subtreeEnd[i])，父节点下标总小于子节点。
+// 世界坐标相对根节点的父坐标系缓存，render传入的原点在绘制时才加上，移动原点不需要重算；
+// setPosition只标记脏节点，下一次遍历前只重算脏子树；
+// update/render都是线性遍历，没有递归和shared_ptr解引用。
+// 树结构变化（增删子对象）时自动在下一次遍历前重建
+class FlatSceneGraph {
+private:
+    std::shared_ptr<GameObjectComponent> root;
+    
+    std::vector<GameObjectComponent*> components;
+    std::vector<uint32_t> parents;        // 根节点的父节点为自身
+    std::vector<uint32_t> subtreeEnds;
+    std::vector<float> localX, localY;
+    std::vector<float> worldX, worldY;
+    std::vector<uint8_t> visibleFlags;
+    std::vector<uint8_t> leafFlags;
+    
+    std::vector<uint32_t> dirtyRoots;
+    std::vector<uint8_t> dirtyFlags;
+    bool structureDirty = false;
+    
+    void flatten(GameObjectComponent* node, uint32_t parent) {
+        uint32_t index = static_cast<uint32_t>(components.size());
+        node->sceneGraph = this;
+        node->sceneNode = index;
+        components.push_back(node);
+        parents.push_back(parent == UINT32_MAX ? index : parent);
+        subtreeEnds.push_back(0);
+        localX.push_back(node->getX());
+        localY.push_back(node->getY());
+        worldX.push_back(0.0f);
+        worldY.push_back(0.0f);
+        visibleFlags.push_back(node->isVisible() ? 1 : 0);
+        size_t childCount = node->getChildCount();
+        leafFlags.push_back(childCount == 0 && dynamic_cast<GameObjectGroup*>(node) == nullptr ? 1 : 0);
+        dirtyFlags.push_back(0);
+        for (size_t i = 0; i < childCount; ++i) {
+            if (auto child = node->getChild(i)) {
+                flatten(child.get(), index);
+            }
+        }
+        subtreeEnds[index] = static_cast<uint32_t>(components.size());
+    }
+    
+    void rebuild() {
+        components.clear();
+        parents.clear();
+        subtreeEnds.clear();
+        localX.clear();
+        localY.clear();
+        worldX.clear();
+        worldY.clear();
+        visibleFlags.clear();
+        leafFlags.clear();
+        dirtyFlags.clear();
+        dirtyRoots.clear();
+        structureDirty = false;
+        if (!root) {
+            return;
+        }
+        flatten(root.get(), UINT32_MAX);
+        // 父节点在前，一次正向遍历即可算出全部世界坐标
+        for (size_t i = 0; i < components.size(); ++i) {
+            uint32_t parent = parents[i];
+            float baseX = parent == i ? 0.0f : worldX[parent];
+            float baseY = parent == i ? 0.0f : worldY[parent];
+            worldX[i] = baseX + localX[i];
+            worldY[i] = baseY + localY[i];
+        }
+    }
+    
+    // 只重算脏节点的子树
+    void refreshTransforms() {
+        if (structureDirty) {
+            rebuild();
+            return;
+        }
+        for (uint32_t dirtyRoot : dirtyRoots) {
+            if (!dirtyFlags[dirtyRoot]) {
+                continue;  // 已被祖先的子树覆盖
+            }
+            for (uint32_t i = dirtyRoot; i < subtreeEnds[dirtyRoot]; ++i) {
+                uint32_t parent = parents[i];
+                float baseX = parent == i ? 0.0f : worldX[parent];
+                float baseY = parent == i ? 0.0f : worldY[parent];
+                worldX[i] = baseX + localX[i];
+                worldY[i] = baseY + localY[i];
+                dirtyFlags[i] = 0;
+            }
+        }
+        dirtyRoots.clear();
+    }
+    
+public:
+    FlatSceneGraph() = default;
+    FlatSceneGraph(const FlatSceneGraph&) = delete;
+    FlatSceneGraph& operator=(const FlatSceneGraph&) = delete;
+    
+    ~FlatSceneGraph() {
+        if (root) {
+            root->detachFromSceneGraph();
+        }
+    }
+    
+    void build(std::shared_ptr<GameObjectComponent> sceneRoot) {
+        if (root) {
+            root->detachFromSceneGraph();
+        }
+        root = std::move(sceneRoot);
+        rebuild();
+    }
+    
+    // 由组件的setPosition调用
+    void onLocalPositionChanged(uint32_t node, float posX, float posY) {
+        if (structureDirty) {
+            return;  // 重建时会重新读取
+        }
+        localX[node] = posX;
+        localY[node] = posY;
+        if (!dirtyFlags[node]) {
+            dirtyFlags[node] = 1;
+            dirtyRoots.push_back(node);
+        }
+    }
+    
+    void onVisibilityChanged(uint32_t node, bool visible) {
+        if (!structureDirty) {
+            visibleFlags[node] = visible ? 1 : 0;
+        }
+    }
+    
+    void invalidateStructure() { structureDirty = true; }
+    
+    // 线性更新所有节点
+    void update(float deltaTime) {
+        if (structureDirty) {
+            rebuild();
+        }
+        for (auto* component : components) {
+            component->updateSelf(deltaTime);
+        }
+    }
+    
+    // 线性渲染，不可见节点整棵子树一次跳过；原点只在绘制时加上
+    void render(float parentX = 0, float parentY = 0) {
+        refreshTransforms();
+        size_t count = components.size();
+        for (size_t i = 0; i < count;) {
+            if (!visibleFlags[i]) {
+                i = subtreeEnds[i];
+                continue;
+            }
+            if (leafFlags[i]) {
+                uint32_t parent = parents[i];
+                float baseX = parentX + (parent == i ? 0.0f : worldX[parent]);
+                float baseY = parentY + (parent == i ? 0.0f : worldY[parent]);
+                components[i]->render(baseX, baseY);
+            }
+            ++i;
+        }
+    }
+    
+    // 查询缓存的世界坐标（相对根节点的父坐标系，不含render传入的原点）
+    bool getWorldPosition(const GameObjectComponent* component, float& outX, float& outY) {
+        if (!component || component->sceneGraph != this) {
+            return false;
+        }
+        refreshTransforms();
+        if (component->sceneGraph != this) {
+            return false;
+        }
+        outX = worldX[component->sceneNode];
+        outY = worldY[component->sceneNode];
+        return true;
+    }
+    
+    size_t getNodeCount() {
+        if (structureDirty) {
+            rebuild();
+        }
+        return components.size();
     }
 };
 
+inline void GameObjectComponent::setPosition(float posX, float posY) {
+    x = posX;
+    y = posY;
+    if (sceneGraph) {
+        sceneGraph->onLocalPositionChanged(sceneNode, posX, posY);
+    }
+}
+
+inline void GameObjectComponent::setVisible(bool vis) {
+    visible = vis;
+    if (sceneGraph) {
+        sceneGraph->onVisibilityChanged(sceneNode, vis);
+    }
+}
+
+inline void GameObjectGroup::addChild(std::shared_ptr<GameObjectComponent> child) {
+    if (child) {
+        children.push_back(child);
+        if (sceneGraph) {
+            sceneGraph->invalidateStructure();
+        }
+    }
+}
+
+inline void GameObjectGroup::removeChild(std::shared_ptr<GameObjectComponent> child) {
+    auto it = std::find(children.begin(), children.end(), child);
+    if (it != children.end()) {
+        child->detachFromSceneGraph();
+        children.erase(
+            std::remove(children.begin(), children.end(), child),
+            children.end()
+        );
+        if (sceneGraph) {
+            sceneGraph->invalidateStructure();
+        }
+    }
+}
+
+inline void GameObjectGroup::clear() {
+    for (auto& child : children) {
+        child->detachFromSceneGraph();
+    }
+    children.clear();
+    if (sceneGraph) {
+        sceneGraph->invalidateStructure();
+    }
+}
+
 // 特殊组合节点 - 场景
 class Scene : public GameObjectGroup {
 private:
@@ -188,10 +438,9 @@ private:
 public:
     Scene(const std::string& sceneName) : GameObjectGroup(sceneName) {}
     
-    void update(float deltaTime) override {
-        // 场景特有的更新逻辑
-        GameObjectGroup::update(deltaTime);
-        
+    // 场景特有的更新逻辑，递归update和扁平场景图都会调用
+    void updateGroup(float deltaTime) override {
+        (void)deltaTime;
         // 可以添加场景级别的逻辑，如碰撞检测、音效管理等
     }
     
@@ -213,6 +462,7 @@ public:
 class GameSceneManager {
 private:
     std::shared_ptr<Scene> currentScene;
+    FlatSceneGraph sceneGraph;
     
 public:
     void createSampleScene() {
@@ -242,17 +492,21 @@ public:
         // 添加到场景
         currentScene->addChild(player);
         currentScene->addChild(ui);
+        
+        sceneGraph.build(currentScene);
     }
     
     void updateScene(float deltaTime) {
         if (currentScene) {
-            currentScene->update(deltaTime);
+            sceneGraph.update(deltaTime);
         }
     }
     
     void renderScene() {
         if (currentScene) {
-            currentScene->render(0, 0);
+            sceneGraph.render(0, 0);
         }
     }
+    
+    FlatSceneGraph& getSceneGraph() { return sceneGraph; }
 };
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <cstdint>
 
 /**
  * 装饰器模式 (Decorator Pattern)
@@ -9,6 +10,20 @@
  * 特点：动态地给对象添加新功能，而不改变其结构
  */
 
+// 角色属性块
+struct CharacterStats {
+    int attack = 0;
+    int defense = 0;
+    int speed = 0;
+    
+    CharacterStats& operator+=(const CharacterStats& other) {
+        attack += other.attack;
+        defense += other.defense;
+        speed += other.speed;
+        return *this;
+    }
+};
+
 // 组件接口 - 游戏角色
 class Character {
 public:
@@ -18,6 +33,13 @@ public:
     virtual int getSpeed() const = 0;
     virtual std::string getDescription() const = 0;
     virtual void useSkill() = 0;
+    
+    virtual CharacterStats getStats() const {
+        return {getAttack(), getDefense(), getSpeed()};
+    }
+    
+    // 基础属性变化后调用，让装饰链重新汇总
+    virtual void refreshStats() {}
 };
 
 // 具体组件 - 基础战士
@@ -44,28 +66,63 @@ public:
 };
 
 // 装饰器基类
+// 每层在构造时就把内层已汇总的属性加上自己的加成缓存下来，
+// 查询属性和描述都是O(1)，不再逐层虚调用和拼接字符串；
+// 内层不可变，只有基础属性变化时才需要refreshStats()
 class CharacterDecorator : public Character {
 protected:
     std::unique_ptr<Character> character;
+    CharacterStats bonus;
+    std::string descriptionSuffix;
+    CharacterStats cachedStats;
+    std::string cachedDescription;
+    
+    void recompute() {
+        cachedStats = character->getStats();
+        cachedStats += bonus;
+        cachedDescription = character->getDescription() + descriptionSuffix;
+    }
     
 public:
     CharacterDecorator(std::unique_ptr<Character> char_ptr) 
-        : character(std::move(char_ptr)) {}
+        : character(std::move(char_ptr)) {
+        recompute();
+    }
+    
+    CharacterDecorator(std::unique_ptr<Character> char_ptr, const CharacterStats& statBonus,
+                       const std::string& suffix)
+        : character(std::move(char_ptr)), bonus(statBonus), descriptionSuffix(suffix) {
+        recompute();
+    }
     
     int getAttack() const override {
-        return character->getAttack();
+        return cachedStats.attack;
     }
     
     int getDefense() const override {
-        return character->getDefense();
+        return cachedStats.defense;
     }
     
     int getSpeed() const override {
-        return character->getSpeed();
+        return cachedStats.speed;
+    }
+    
+    CharacterStats getStats() const override {
+        return cachedStats;
     }
     
     std::string getDescription() const override {
-        return character->getDescription();
+        return cachedDescription;
+    }
+    
+    void refreshStats() override {
+        character->refreshStats();
+        recompute();
+    }
+    
+    // 取下这一层装饰，返回内层角色
+    std::unique_ptr<Character> releaseInner() {
+        return std::move(character);
     }
     
     void useSkill() override {
@@ -81,15 +138,8 @@ private:
     
 public:
     WeaponDecorator(std::unique_ptr<Character> char_ptr, const std::string& weapon, int bonus)
-        : CharacterDecorator(std::move(char_ptr)), weaponName(weapon), attackBonus(bonus) {}
-    
-    int getAttack() const override {
-        return CharacterDecorator::getAttack() + attackBonus;
-    }
-    
-    std::string getDescription() const override {
-        return CharacterDecorator::getDescription() + " + " + weaponName;
-    }
+        : CharacterDecorator(std::move(char_ptr), {bonus, 0, 0}, " + " + weapon),
+          weaponName(weapon), attackBonus(bonus) {}
     
     void useSkill() override {
         CharacterDecorator::useSkill();
@@ -105,15 +155,8 @@ private:
     
 public:
     ArmorDecorator(std::unique_ptr<Character> char_ptr, const std::string& armor, int bonus)
-        : CharacterDecorator(std::move(char_ptr)), armorName(armor), defenseBonus(bonus) {}
-    
-    int getDefense() const override {
-        return CharacterDecorator::getDefense() + defenseBonus;
-    }
-    
-    std::string getDescription() const override {
-        return CharacterDecorator::getDescription() + " + " + armorName;
-    }
+        : CharacterDecorator(std::move(char_ptr), {0, bonus, 0}, " + " + armor),
+          armorName(armor), defenseBonus(bonus) {}
 };
 
 // 具体装饰器 - 敏捷药水装饰器
@@ -124,15 +167,8 @@ private:
     
 public:
     SpeedPotionDecorator(std::unique_ptr<Character> char_ptr, int bonus, int time)
-        : CharacterDecorator(std::move(char_ptr)), speedBonus(bonus), duration(time) {}
-    
-    int getSpeed() const override {
-        return CharacterDecorator::getSpeed() + speedBonus;
-    }
-    
-    std::string getDescription() const override {
-        return CharacterDecorator::getDescription() + " + 敏捷药水";
-    }
+        : CharacterDecorator(std::move(char_ptr), {0, 0, bonus}, " + 敏捷药水"),
+          speedBonus(bonus), duration(time) {}
     
     void useSkill() override {
         CharacterDecorator::useSkill();
@@ -153,23 +189,12 @@ private:
 public:
     MagicEnchantmentDecorator(std::unique_ptr<Character> char_ptr, 
                              const std::string& type, int attackBonus, int defenseBonus)
-        : CharacterDecorator(std::move(char_ptr)), 
+        : CharacterDecorator(std::move(char_ptr), {attackBonus, defenseBonus, 0},
+                             " + " + type + "附魔"),
           enchantmentType(type), 
           magicAttackBonus(attackBonus), 
           magicDefenseBonus(defenseBonus) {}
     
-    int getAttack() const override {
-        return CharacterDecorator::getAttack() + magicAttackBonus;
-    }
-    
-    int getDefense() const override {
-        return CharacterDecorator::getDefense() + magicDefenseBonus;
-    }
-    
-    std::string getDescription() const override {
-        return CharacterDecorator::getDescription() + " + " + enchantmentType + "附魔";
-    }
-    
     void useSkill() override {
         CharacterDecorator::useSkill();
         // 魔法附魔特殊效果
@@ -177,15 +202,18 @@ public:
 };
 
 // 装饰器管理器 - 管理多个装饰器效果
+// 每次增删装饰或刷新属性都让版本号递增，战斗代码可以按版本号缓存属性
 class DecorationManager {
 private:
     std::vector<std::string> activeDecorations;
+    uint32_t version = 0;
     
 public:
     // 应用武器装饰
     std::unique_ptr<Character> applyWeapon(std::unique_ptr<Character> character, 
                                           const std::string& weaponName, int attackBonus) {
         activeDecorations.push_back("武器: " + weaponName);
+        version++;
         return std::make_unique<WeaponDecorator>(std::move(character), weaponName, attackBonus);
     }
     
@@ -193,6 +221,7 @@ public:
     std::unique_ptr<Character> applyArmor(std::unique_ptr<Character> character, 
                                          const std::string& armorName, int defenseBonus) {
         activeDecorations.push_back("护甲: " + armorName);
+        version++;
         return std::make_unique<ArmorDecorator>(std::move(character), armorName, defenseBonus);
     }
     
@@ -200,6 +229,7 @@ public:
     std::unique_ptr<Character> applySpeedPotion(std::unique_ptr<Character> character, 
                                                int speedBonus, int duration) {
         activeDecorations.push_back("敏捷药水");
+        version++;
         return std::make_unique<SpeedPotionDecorator>(std::move(character), speedBonus, duration);
     }
     
@@ -208,6 +238,7 @@ public:
                                                     const std::string& type, 
                                                     int attackBonus, int defenseBonus) {
         activeDecorations.push_back("魔法附魔: " + type);
+        version++;
         return std::make_unique<MagicEnchantmentDecorator>(
             std::move(character), type, attackBonus, defenseBonus);
     }
@@ -217,8 +248,30 @@ public:
         return activeDecorations;
     }
     
+    // 移除最外层装饰，返回内层角色；不是装饰器时原样返回
+    std::unique_ptr<Character> removeOutermost(std::unique_ptr<Character> character) {
+        auto* decorator = dynamic_cast<CharacterDecorator*>(character.get());
+        if (!decorator) {
+            return character;
+        }
+        if (!activeDecorations.empty()) {
+            activeDecorations.pop_back();
+        }
+        version++;
+        return decorator->releaseInner();
+    }
+    
+    // 基础属性变化后让整条装饰链重新汇总
+    void refreshStats(Character& character) {
+        character.refreshStats();
+        version++;
+    }
+    
+    uint32_t getVersion() const { return version; }
+    
     // 清空装饰记录
     void clearDecorations() {
         activeDecorations.clear();
+        version++;
     }
 };
\ No newline at end of file
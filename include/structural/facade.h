@@ -2,6 +2,8 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <stdexcept>
+#include "structural/profiler.h"
 
 /**
  * 外观模式 (Facade Pattern)
@@ -29,14 +31,17 @@ public:
     }
     
     void beginFrame() {
+        PROFILE_ZONE("GraphicsEngine::beginFrame");
         // 开始帧渲染
     }
     
     void endFrame() {
+        PROFILE_ZONE("GraphicsEngine::endFrame");
         // 结束帧渲染
     }
     
     void drawSprite(float x, float y, const std::string& texture) {
+        PROFILE_COUNT(ProfileCounter::DrawCalls, 1);
         // 绘制精灵
     }
 };
@@ -110,10 +115,12 @@ public:
     }
     
     void simulateStep(float deltaTime) {
+        PROFILE_ZONE("PhysicsEngine::simulateStep");
         // 执行物理模拟步骤
     }
     
     void checkCollisions() {
+        PROFILE_ZONE("PhysicsEngine::checkCollisions");
         // 检查碰撞
     }
 };
@@ -207,21 +214,50 @@ public:
     }
     
     // 简化的游戏循环接口
+    // 每个阶段计入对应子系统的帧时间，帧结束时汇总到剖析器
     void updateGame(float deltaTime) {
         if (!isInitialized) return;
         
-        // 更新输入
-        input->updateInput();
-        
-        // 更新物理
-        physics->simulateStep(deltaTime);
-        physics->checkCollisions();
-        
-        // 渲染
-        graphics->beginFrame();
-        graphics->drawSprite(100, 100, "player.png");
-        graphics->drawSprite(0, 0, "background.png");
-        graphics->endFrame();
+        {
+            PROFILE_ZONE("GameEngineFacade::updateGame");
+            
+            // 更新输入
+            {
+                PROFILE_SUBSYSTEM(ProfileSubsystem::Input, "Input");
+                input->updateInput();
+            }
+            
+            // 更新物理
+            {
+                PROFILE_SUBSYSTEM(ProfileSubsystem::Physics, "Physics");
+                physics->simulateStep(deltaTime);
+            }
+            {
+                PROFILE_SUBSYSTEM(ProfileSubsystem::Collision, "Collision");
+                physics->checkCollisions();
+            }
+            
+            // 渲染
+            {
+                PROFILE_SUBSYSTEM(ProfileSubsystem::Rendering, "Rendering");
+                graphics->beginFrame();
+                graphics->drawSprite(100, 100, "player.png");
+                graphics->drawSprite(0, 0, "background.png");
+                graphics->endFrame();
+            }
+        }
+        PROFILE_FRAME_END();
+    }
+    
+    // 剖析数据：Chrome Trace导出和滚动帧时间直方图
+    Profiler& getProfiler() { return Profiler::getInstance(); }
+    
+    bool exportProfile(const std::string& tracePath) const {
+        return Profiler::getInstance().writeChromeTrace(tracePath);
+    }
+    
+    std::string getFrameTimeReport() const {
+        return Profiler::getInstance().formatHistogramReport();
     }
     
     // 简化的资源管理接口
@@ -2,6 +2,30 @@
 #include <unordered_map>
 #include <memory>
 #include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+// SIMD指令集检测：x86上编译SSE/AVX2两个版本并在运行时选择，ARM上使用NEON
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define FLYWEIGHT_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define FLYWEIGHT_TARGET_AVX2
+#else
+#define FLYWEIGHT_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define FLYWEIGHT_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
 
 /**
  * 享元模式 (Flyweight Pattern)
@@ -43,62 +67,241 @@ public:
     int getHeight() const override { return height; }
 };
 
+// 纹理句柄 - 32位：低12位为槽位索引，高20位为代数
+// 槽位被释放并复用后代数递增，旧句柄随之失效
+class TextureHandle {
+private:
+    uint32_t value;
+    
+public:
+    static constexpr uint32_t INDEX_BITS = 12;
+    static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+    static constexpr uint32_t GENERATION_MASK = (1u << (32 - INDEX_BITS)) - 1;
+    
+    TextureHandle() : value(0) {}
+    TextureHandle(uint32_t index, uint32_t generation)
+        : value((generation << INDEX_BITS) | (index & INDEX_MASK)) {}
+    
+    uint32_t getIndex() const { return value & INDEX_MASK; }
+    uint32_t getGeneration() const { return value >> INDEX_BITS; }
+    uint32_t getValue() const { return value; }
+    bool isValid() const { return value != 0; }  // 代数从1开始，0表示无效句柄
+    
+    bool operator==(const TextureHandle& other) const { return value == other.value; }
+    bool operator!=(const TextureHandle& other) const { return value != other.value; }
+};
+
 // 享元工厂 - 纹理管理器
+// 名称只在acquire()时哈希一次，之后通过句柄以数组下标解析（无锁、无等待）
+// 注册按名称哈希分片加锁，可在多个工作线程上并发构建世界
 class TextureManager {
+public:
+    static constexpr uint32_t MAX_TEXTURES = 1u << TextureHandle::INDEX_BITS;
+    static constexpr size_t SHARD_COUNT = 16;
+    
 private:
-    static std::unique_ptr<TextureManager> instance;
-    std::unordered_map<std::string, std::shared_ptr<SpriteTexture>> texturePool;
+    struct Slot {
+        std::atomic<uint32_t> generation{0};          // 0表示槽位空闲
+        std::atomic<SpriteTexture*> texture{nullptr};
+        std::atomic<uint32_t> refCount{0};
+        std::unique_ptr<SpriteTexture> owner;
+        std::string name;
+        uint32_t lastGeneration = 0;
+    };
     
-    TextureManager() = default;
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, TextureHandle> handles;
+    };
+    
+    std::unique_ptr<Slot[]> slots;
+    Shard shards[SHARD_COUNT];
+    
+    std::mutex slotMutex;                 // 保护空闲槽位列表
+    std::vector<uint32_t> freeSlots;
+    uint32_t nextUnusedSlot;
+    std::atomic<size_t> liveCount;
+    
+    TextureManager() : slots(new Slot[MAX_TEXTURES]), nextUnusedSlot(1), liveCount(0) {}
+    
+    Shard& shardFor(const std::string& textureName) {
+        return shards[std::hash<std::string>{}(textureName) % SHARD_COUNT];
+    }
+    
+    uint32_t allocateSlot() {
+        std::lock_guard<std::mutex> lock(slotMutex);
+        if (!freeSlots.empty()) {
+            uint32_t index = freeSlots.back();
+            freeSlots.pop_back();
+            return index;
+        }
+        if (nextUnusedSlot >= MAX_TEXTURES) {
+            throw std::runtime_error("纹理槽位已满");
+        }
+        return nextUnusedSlot++;  // 槽位0保留，保证有效句柄非零
+    }
+    
+    void freeSlot(uint32_t index) {
+        std::lock_guard<std::mutex> lock(slotMutex);
+        freeSlots.push_back(index);
+    }
     
 public:
+    TextureManager(const TextureManager&) = delete;
+    TextureManager& operator=(const TextureManager&) = delete;
+    
     static TextureManager& getInstance() {
-        if (!instance) {
-            instance = std::unique_ptr<TextureManager>(new TextureManager());
-        }
-        return *instance;
+        static TextureManager instance;
+        return instance;
     }
     
-    // 获取享元对象（如果不存在则创建）
-    std::shared_ptr<SpriteTexture> getTexture(const std::string& textureName) {
-        auto it = texturePool.find(textureName);
-        if (it != texturePool.end()) {
+    // 获取纹理句柄（如果不存在则创建），引用计数加一
+    TextureHandle acquire(const std::string& textureName) {
+        Shard& shard = shardFor(textureName);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        
+        auto it = shard.handles.find(textureName);
+        if (it != shard.handles.end()) {
+            slots[it->second.getIndex()].refCount.fetch_add(1, std::memory_order_relaxed);
             return it->second;  // 返回已存在的享元
         }
         
         // 创建新的享元对象
         // 这里简化处理，实际应该从文件加载
         int width = 64, height = 64;  // 默认尺寸
-        auto texture = std::make_shared<ConcreteTexture>(textureName, width, height);
-        texturePool[textureName] = texture;
+        uint32_t index = allocateSlot();
+        Slot& slot = slots[index];
+        uint32_t generation = (slot.lastGeneration + 1) & TextureHandle::GENERATION_MASK;
+        if (generation == 0) {
+            generation = 1;
+        }
+        slot.lastGeneration = generation;
+        slot.owner = std::make_unique<ConcreteTexture>(textureName, width, height);
+        slot.name = textureName;
+        slot.refCount.store(1, std::memory_order_relaxed);
+        slot.texture.store(slot.owner.get(), std::memory_order_relaxed);
+        slot.generation.store(generation, std::memory_order_release);  // 发布槽位
+        
+        TextureHandle handle(index, generation);
+        shard.handles.emplace(textureName, handle);
+        liveCount.fetch_add(1, std::memory_order_relaxed);
+        return handle;
+    }
+    
+    // 为已持有的句柄增加一个引用
+    void addRef(TextureHandle handle) {
+        if (resolve(handle)) {
+            slots[handle.getIndex()].refCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    
+    // 释放一个引用，最后一个引用释放时销毁纹理并回收槽位
+    void release(TextureHandle handle) {
+        if (!handle.isValid()) {
+            return;
+        }
+        Slot& slot = slots[handle.getIndex()];
+        if (slot.generation.load(std::memory_order_acquire) != handle.getGeneration()) {
+            return;  // 过期句柄
+        }
+        
+        Shard& shard = shardFor(slot.name);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (slot.generation.load(std::memory_order_relaxed) != handle.getGeneration()) {
+            return;
+        }
+        if (slot.refCount.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
         
-        return texture;
+        shard.handles.erase(slot.name);
+        slot.generation.store(0, std::memory_order_release);
+        slot.texture.store(nullptr, std::memory_order_relaxed);
+        slot.owner.reset();
+        slot.name.clear();
+        liveCount.fetch_sub(1, std::memory_order_relaxed);
+        freeSlot(handle.getIndex());
+    }
+    
+    // 句柄解析：一次数组下标和代数比较，过期句柄返回nullptr
+    // 返回的指针在调用方持有句柄引用期间有效
+    SpriteTexture* resolve(TextureHandle handle) const {
+        uint32_t index = handle.getIndex();
+        if (!handle.isValid() || index >= MAX_TEXTURES) {
+            return nullptr;
+        }
+        const Slot& slot = slots[index];
+        if (slot.generation.load(std::memory_order_acquire) != handle.getGeneration()) {
+            return nullptr;
+        }
+        return slot.texture.load(std::memory_order_relaxed);
+    }
+    
+    // 兼容接口：返回的shared_ptr析构时自动释放句柄
+    std::shared_ptr<SpriteTexture> getTexture(const std::string& textureName) {
+        TextureHandle handle = acquire(textureName);
+        return std::shared_ptr<SpriteTexture>(resolve(handle),
+            [this, handle](SpriteTexture*) { release(handle); });
     }
     
     // 获取当前缓存的纹理数量
     size_t getTextureCount() const {
-        return texturePool.size();
+        return liveCount.load(std::memory_order_relaxed);
     }
+};
+
+// 纹理引用 - RAII持有一个纹理句柄，拷贝时增加引用，析构时释放
+class TextureRef {
+private:
+    TextureHandle handle;
     
-    // 清理未使用的纹理
-    void cleanup() {
-        auto it = texturePool.begin();
-        while (it != texturePool.end()) {
-            if (it->second.use_count() == 1) {  // 只有管理器持有引用
-                it = texturePool.erase(it);
-            } else {
-                ++it;
-            }
+public:
+    TextureRef() = default;
+    explicit TextureRef(const std::string& textureName)
+        : handle(TextureManager::getInstance().acquire(textureName)) {}
+    explicit TextureRef(TextureHandle h) : handle(h) {
+        TextureManager::getInstance().addRef(handle);
+    }
+    
+    TextureRef(const TextureRef& other) : handle(other.handle) {
+        TextureManager::getInstance().addRef(handle);
+    }
+    TextureRef(TextureRef&& other) noexcept : handle(other.handle) {
+        other.handle = TextureHandle();
+    }
+    TextureRef& operator=(TextureRef other) noexcept {
+        std::swap(handle, other.handle);
+        return *this;
+    }
+    ~TextureRef() { reset(); }
+    
+    void reset() {
+        if (handle.isValid()) {
+            TextureManager::getInstance().release(handle);
+            handle = TextureHandle();
         }
     }
+    
+    TextureHandle getHandle() const { return handle; }
+    SpriteTexture* get() const { return TextureManager::getInstance().resolve(handle); }
+    SpriteTexture* operator->() const { return get(); }
+    explicit operator bool() const { return handle.isValid(); }
 };
 
-std::unique_ptr<TextureManager> TextureManager::instance = nullptr;
+// 精灵实例 - 批量提交给渲染器的外部状态（屏幕坐标）
+// 渲染器按(layer, texture)排序后，每个纹理一次实例化绘制
+struct SpriteInstance {
+    float x, y;
+    float scale;
+    float rotation;
+    TextureHandle texture;
+    uint32_t layer;          // 绘制层，小的先画
+};
 
 // 上下文类 - 精灵对象（包含外部状态）
 class SpriteEntity {
 private:
-    std::shared_ptr<SpriteTexture> texture;  // 享元引用
+    TextureRef texture;  // 享元引用
     
     // 外部状态：每个精灵独有的状态
     float x, y;           // 位置
@@ -108,10 +311,12 @@ private:
     
 public:
     SpriteEntity(const std::string& textureName, float posX = 0, float posY = 0) 
-        : x(posX), y(posY), scale(1.0f), rotation(0.0f), velocityX(0), velocityY(0) {
-        // 从享元工厂获取纹理（享元对象）
-        texture = TextureManager::getInstance().getTexture(textureName);
-    }
+        : texture(textureName),  // 从享元工厂获取纹理（享元对象）
+          x(posX), y(posY), scale(1.0f), rotation(0.0f), velocityX(0), velocityY(0) {}
+    
+    SpriteEntity(TextureHandle textureHandle, float posX = 0, float posY = 0)
+        : texture(textureHandle),
+          x(posX), y(posY), scale(1.0f), rotation(0.0f), velocityX(0), velocityY(0) {}
     
     void update(float deltaTime) {
         // 更新外部状态
@@ -125,6 +330,11 @@ public:
         texture->render(x, y, scale, rotation);
     }
     
+    // 追加到批量绘制列表
+    void render(std::vector<SpriteInstance>& out, uint32_t layer = 0) const {
+        out.push_back({x, y, scale, rotation, texture.getHandle(), layer});
+    }
+    
     // 外部状态的访问器
     void setPosition(float posX, float posY) { x = posX; y = posY; }
     void setScale(float s) { scale = s; }
@@ -135,91 +345,455 @@ public:
     std::string getTextureName() const { return texture->getTextureName(); }
 };
 
+// 积分与剔除内核的参数（SoA数组指针）
+struct SpriteKernelArgs {
+    float* x;
+    float* y;
+    float* rotation;
+    const float* velocityX;
+    const float* velocityY;
+    size_t count;
+    float deltaTime;
+    float rotationSpeed;     // 度/秒
+    // 剔除矩形，culled为nullptr时只积分不剔除
+    float minX, minY, maxX, maxY;
+    uint8_t* culled;         // 输出：1表示超出矩形
+};
+
+// 精灵积分/剔除内核 - 位置 += 速度 * dt，旋转 += 速度 * dt，并生成出界掩码
+// 提供标量、SSE、AVX2、NEON实现，首次调用时根据CPU特性选择
+class SpriteKernels {
+public:
+    using KernelFn = size_t (*)(const SpriteKernelArgs&);
+    
+    // 执行当前CPU支持的最快实现，返回被剔除的数量
+    static size_t integrateAndCull(const SpriteKernelArgs& args) {
+        return active().fn(args);
+    }
+    
+    static const char* activeKernelName() { return active().name; }
+    
+    // 标量实现，也用于处理SIMD版本的尾部元素
+    static size_t scalar(const SpriteKernelArgs& a) {
+        return scalarRange(a, 0);
+    }
+    
+#if defined(FLYWEIGHT_SIMD_X86)
+    static size_t sse(const SpriteKernelArgs& a) {
+        const __m128 dt = _mm_set1_ps(a.deltaTime);
+        const __m128 rotStep = _mm_set1_ps(a.rotationSpeed * a.deltaTime);
+        const __m128 minX = _mm_set1_ps(a.minX), maxX = _mm_set1_ps(a.maxX);
+        const __m128 minY = _mm_set1_ps(a.minY), maxY = _mm_set1_ps(a.maxY);
+        size_t culledCount = 0;
+        size_t i = 0;
+        for (; i + 4 <= a.count; i += 4) {
+            __m128 x = _mm_add_ps(_mm_loadu_ps(a.x + i), _mm_mul_ps(_mm_loadu_ps(a.velocityX + i), dt));
+            __m128 y = _mm_add_ps(_mm_loadu_ps(a.y + i), _mm_mul_ps(_mm_loadu_ps(a.velocityY + i), dt));
+            _mm_storeu_ps(a.x + i, x);
+            _mm_storeu_ps(a.y + i, y);
+            _mm_storeu_ps(a.rotation + i, _mm_add_ps(_mm_loadu_ps(a.rotation + i), rotStep));
+            if (a.culled) {
+                __m128 out = _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(x, minX), _mm_cmpgt_ps(x, maxX)),
+                                       _mm_or_ps(_mm_cmplt_ps(y, minY), _mm_cmpgt_ps(y, maxY)));
+                culledCount += writeMask(a.culled + i, _mm_movemask_ps(out), 4);
+            }
+        }
+        return culledCount + scalarRange(a, i);
+    }
+    
+    FLYWEIGHT_TARGET_AVX2
+    static size_t avx2(const SpriteKernelArgs& a) {
+        const __m256 dt = _mm256_set1_ps(a.deltaTime);
+        const __m256 rotStep = _mm256_set1_ps(a.rotationSpeed * a.deltaTime);
+        const __m256 minX = _mm256_set1_ps(a.minX), maxX = _mm256_set1_ps(a.maxX);
+        const __m256 minY = _mm256_set1_ps(a.minY), maxY = _mm256_set1_ps(a.maxY);
+        size_t culledCount = 0;
+        size_t i = 0;
+        for (; i + 8 <= a.count; i += 8) {
+            __m256 x = _mm256_add_ps(_mm256_loadu_ps(a.x + i), _mm256_mul_ps(_mm256_loadu_ps(a.velocityX + i), dt));
+            __m256 y = _mm256_add_ps(_mm256_loadu_ps(a.y + i), _mm256_mul_ps(_mm256_loadu_ps(a.velocityY + i), dt));
+            _mm256_storeu_ps(a.x + i, x);
+            _mm256_storeu_ps(a.y + i, y);
+            _mm256_storeu_ps(a.rotation + i, _mm256_add_ps(_mm256_loadu_ps(a.rotation + i), rotStep));
+            if (a.culled) {
+                __m256 out = _mm256_or_ps(
+                    _mm256_or_ps(_mm256_cmp_ps(x, minX, _CMP_LT_OQ), _mm256_cmp_ps(x, maxX, _CMP_GT_OQ)),
+                    _mm256_or_ps(_mm256_cmp_ps(y, minY, _CMP_LT_OQ), _mm256_cmp_ps(y, maxY, _CMP_GT_OQ)));
+                culledCount += writeMask(a.culled + i, _mm256_movemask_ps(out), 8);
+            }
+        }
+        return culledCount + scalarRange(a, i);
+    }
+#endif
+    
+#if defined(FLYWEIGHT_SIMD_NEON)
+    static size_t neon(const SpriteKernelArgs& a) {
+        const float32x4_t rotStep = vdupq_n_f32(a.rotationSpeed * a.deltaTime);
+        const float32x4_t minX = vdupq_n_f32(a.minX), maxX = vdupq_n_f32(a.maxX);
+        const float32x4_t minY = vdupq_n_f32(a.minY), maxY = vdupq_n_f32(a.maxY);
+        size_t culledCount = 0;
+        size_t i = 0;
+        for (; i + 4 <= a.count; i += 4) {
+            float32x4_t x = vmlaq_n_f32(vld1q_f32(a.x + i), vld1q_f32(a.velocityX + i), a.deltaTime);
+            float32x4_t y = vmlaq_n_f32(vld1q_f32(a.y + i), vld1q_f32(a.velocityY + i), a.deltaTime);
+            vst1q_f32(a.x + i, x);
+            vst1q_f32(a.y + i, y);
+            vst1q_f32(a.rotation + i, vaddq_f32(vld1q_f32(a.rotation + i), rotStep));
+            if (a.culled) {
+                uint32x4_t out = vorrq_u32(vorrq_u32(vcltq_f32(x, minX), vcgtq_f32(x, maxX)),
+                                           vorrq_u32(vcltq_f32(y, minY), vcgtq_f32(y, maxY)));
+                int bits = (vgetq_lane_u32(out, 0) & 1) | (vgetq_lane_u32(out, 1) & 2) |
+                           (vgetq_lane_u32(out, 2) & 4) | (vgetq_lane_u32(out, 3) & 8);
+                culledCount += writeMask(a.culled + i, bits, 4);
+            }
+        }
+        return culledCount + scalarRange(a, i);
+    }
+#endif
+    
+private:
+    struct Selection {
+        KernelFn fn;
+        const char* name;
+    };
+    
+    static size_t scalarRange(const SpriteKernelArgs& a, size_t begin) {
+        const float rotStep = a.rotationSpeed * a.deltaTime;
+        size_t culledCount = 0;
+        for (size_t i = begin; i < a.count; ++i) {
+            a.x[i] += a.velocityX[i] * a.deltaTime;
+            a.y[i] += a.velocityY[i] * a.deltaTime;
+            a.rotation[i] += rotStep;
+            if (a.culled) {
+                bool out = a.x[i] < a.minX || a.x[i] > a.maxX ||
+                           a.y[i] < a.minY || a.y[i] > a.maxY;
+                a.culled[i] = out ? 1 : 0;
+                culledCount += out ? 1 : 0;
+            }
+        }
+        return culledCount;
+    }
+    
+    static size_t writeMask(uint8_t* dst, int bits, int lanes) {
+        size_t n = 0;
+        for (int k = 0; k < lanes; ++k) {
+            dst[k] = static_cast<uint8_t>((bits >> k) & 1);
+            n += dst[k];
+        }
+        return n;
+    }
+    
+    static bool cpuHasAVX2() {
+#if defined(FLYWEIGHT_SIMD_X86) && defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#elif defined(FLYWEIGHT_SIMD_X86)
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+    
+    static Selection select() {
+#if defined(FLYWEIGHT_SIMD_X86)
+        if (cpuHasAVX2()) {
+            return {&SpriteKernels::avx2, "avx2"};
+        }
+        return {&SpriteKernels::sse, "sse"};
+#elif defined(FLYWEIGHT_SIMD_NEON)
+        return {&SpriteKernels::neon, "neon"};
+#else
+        return {&SpriteKernels::scalar, "scalar"};
+#endif
+    }
+    
+    static const Selection& active() {
+        static const Selection selection = select();
+        return selection;
+    }
+};
+
+// 粒子池 - 结构数组(SoA)布局的固定容量粒子存储
+// 每个属性存放在独立的连续数组中，更新和剔除都是线性扫描，热路径上不分配内存
+class ParticlePool {
+private:
+    std::vector<float> posX, posY;        // 位置
+    std::vector<float> velX, velY;        // 速度
+    std::vector<float> scales;            // 缩放
+    std::vector<float> rotations;         // 旋转角度
+    std::vector<uint8_t> culled;          // 剔除内核输出的出界掩码
+    size_t count;                         // 当前存活粒子数
+    
+    SpriteKernelArgs kernelArgs(float deltaTime) {
+        SpriteKernelArgs args{};
+        args.x = posX.data();
+        args.y = posY.data();
+        args.rotation = rotations.data();
+        args.velocityX = velX.data();
+        args.velocityY = velY.data();
+        args.count = count;
+        args.deltaTime = deltaTime;
+        args.rotationSpeed = 90.0f;
+        return args;
+    }
+    
+public:
+    explicit ParticlePool(size_t capacity)
+        : posX(capacity), posY(capacity), velX(capacity), velY(capacity),
+          scales(capacity), rotations(capacity), culled(capacity), count(0) {}
+    
+    // 添加粒子，池满时返回false（不会扩容）
+    bool spawn(float x, float y, float vx, float vy, float scale) {
+        if (count >= posX.size()) {
+            return false;
+        }
+        posX[count] = x;
+        posY[count] = y;
+        velX[count] = vx;
+        velY[count] = vy;
+        scales[count] = scale;
+        rotations[count] = 0.0f;
+        ++count;
+        return true;
+    }
+    
+    // 移除粒子：用最后一个粒子覆盖被移除的位置（不保持顺序）
+    void kill(size_t index) {
+        --count;
+        posX[index] = posX[count];
+        posY[index] = posY[count];
+        velX[index] = velX[count];
+        velY[index] = velY[count];
+        scales[index] = scales[count];
+        rotations[index] = rotations[count];
+    }
+    
+    // 积分：位置 += 速度 * dt，旋转 += 90度/秒
+    void integrate(float deltaTime) {
+        SpriteKernels::integrateAndCull(kernelArgs(deltaTime));
+    }
+    
+    // 积分并剔除位于矩形区域之外的粒子
+    void integrateAndCull(float deltaTime, float minX, float minY, float maxX, float maxY) {
+        SpriteKernelArgs args = kernelArgs(deltaTime);
+        args.minX = minX;
+        args.minY = minY;
+        args.maxX = maxX;
+        args.maxY = maxY;
+        args.culled = culled.data();
+        if (SpriteKernels::integrateAndCull(args) == 0) {
+            return;
+        }
+        
+        // 从后向前移除：换入的末尾粒子都已确认保留
+        for (size_t i = count; i-- > 0;) {
+            if (culled[i]) {
+                kill(i);
+            }
+        }
+    }
+    
+    void clear() { count = 0; }
+    
+    size_t size() const { return count; }
+    size_t getCapacity() const { return posX.size(); }
+    
+    float getX(size_t i) const { return posX[i]; }
+    float getY(size_t i) const { return posY[i]; }
+    float getScale(size_t i) const { return scales[i]; }
+    float getRotation(size_t i) const { return rotations[i]; }
+};
+
 // 粒子系统 - 享元模式的典型应用
 class ParticleSystem {
 private:
-    std::vector<std::unique_ptr<SpriteEntity>> particles;
-    std::string particleTextureName;
+    TextureRef texture;  // 整个系统共享一个纹理享元
+    ParticlePool pool;
     
 public:
-    ParticleSystem(const std::string& textureName) : particleTextureName(textureName) {}
+    static constexpr size_t DEFAULT_CAPACITY = 65536;
     
-    void emitParticle(float x, float y) {
-        // 创建新粒子，所有粒子共享同一个纹理享元
-        auto particle = std::make_unique<SpriteEntity>(particleTextureName, x, y);
-        
+    ParticleSystem(const std::string& textureName, size_t capacity = DEFAULT_CAPACITY)
+        : texture(textureName), pool(capacity) {}
+    
+    // 发射粒子，池已满时丢弃并返回false
+    bool emitParticle(float x, float y) {
         // 设置随机的外部状态
-        particle->setVelocity(
-            (rand() % 200 - 100) / 10.0f,  // 随机水平速度
-            (rand() % 200 - 100) / 10.0f   // 随机垂直速度
-        );
-        particle->setScale(0.5f + (rand() % 100) / 200.0f);  // 随机缩放
-        
-        particles.push_back(std::move(particle));
+        float vx = (rand() % 200 - 100) / 10.0f;      // 随机水平速度
+        float vy = (rand() % 200 - 100) / 10.0f;      // 随机垂直速度
+        float scale = 0.5f + (rand() % 100) / 200.0f; // 随机缩放
+        return pool.spawn(x, y, vx, vy, scale);
     }
     
     void update(float deltaTime) {
-        for (auto& particle : particles) {
-            particle->update(deltaTime);
-        }
-        
-        // 移除超出屏幕的粒子
-        particles.erase(
-            std::remove_if(particles.begin(), particles.end(),
-                [](const std::unique_ptr<SpriteEntity>& p) {
-                    return p->getX() < -100 || p->getX() > 1920 || 
-                           p->getY() < -100 || p->getY() > 1080;
-                }),
-            particles.end()
-        );
+        // 积分并移除超出屏幕的粒子
+        pool.integrateAndCull(deltaTime, -100.0f, -100.0f, 1920.0f, 1080.0f);
     }
     
     void render() const {
-        for (const auto& particle : particles) {
-            particle->render();
+        const SpriteTexture* tex = texture.get();
+        for (size_t i = 0; i < pool.size(); ++i) {
+            tex->render(pool.getX(i), pool.getY(i), pool.getScale(i), pool.getRotation(i));
         }
     }
     
-    size_t getParticleCount() const { return particles.size(); }
+    // 追加到批量绘制列表
+    void render(std::vector<SpriteInstance>& out, uint32_t layer = 0) const {
+        TextureHandle handle = texture.getHandle();
+        for (size_t i = 0; i < pool.size(); ++i) {
+            out.push_back({pool.getX(i), pool.getY(i), pool.getScale(i), pool.getRotation(i),
+                           handle, layer});
+        }
+    }
+    
+    size_t getParticleCount() const { return pool.size(); }
+    size_t getCapacity() const { return pool.getCapacity(); }
 };
 
 // 瓦片地图 - 另一个享元模式应用
+// 按32x32分块平铺存储16位调色板索引（每个瓦片2字节），网格位置由下标隐含
+// 渲染时根据摄像机直接算出可见瓦片范围，开销只与可见瓦片数有关
 class TileMap {
-private:
-    struct TileData {
-        std::shared_ptr<SpriteTexture> texture;  // 享元引用
-        int gridX, gridY;  // 外部状态：网格位置
-    };
+public:
+    static constexpr int CHUNK_SIZE = 32;
+    static constexpr int CHUNK_TILES = CHUNK_SIZE * CHUNK_SIZE;
+    static constexpr uint16_t EMPTY_TILE = 0;
     
-    std::vector<std::vector<TileData>> tiles;
+private:
+    std::vector<uint16_t> tiles;                 // 分块连续存储的调色板索引
+    std::vector<TextureRef> palette;             // 调色板：索引 -> 纹理享元，0号为空
+    std::vector<const SpriteTexture*> paletteTextures;  // 调色板解析缓存
+    std::unordered_map<uint32_t, uint16_t> paletteLookup;  // 句柄 -> 调色板索引
     int mapWidth, mapHeight;
+    int chunksX, chunksY;
     int tileSize;
+    float viewWidth, viewHeight;
+    
+    size_t tileOffset(int x, int y) const {
+        size_t chunk = static_cast<size_t>(y / CHUNK_SIZE) * chunksX + (x / CHUNK_SIZE);
+        return chunk * CHUNK_TILES + (y % CHUNK_SIZE) * CHUNK_SIZE + (x % CHUNK_SIZE);
+    }
+    
+    // 无法解析的句柄（无效或已释放）返回EMPTY_TILE，不进入调色板
+    uint16_t paletteIndexFor(const TextureRef& texture) {
+        auto it = paletteLookup.find(texture.getHandle().getValue());
+        if (it != paletteLookup.end()) {
+            return it->second;
+        }
+        const SpriteTexture* resolved = texture.get();
+        if (!resolved) {
+            return EMPTY_TILE;
+        }
+        if (palette.size() > UINT16_MAX) {
+            throw std::runtime_error("瓦片调色板已满");
+        }
+        uint16_t index = static_cast<uint16_t>(palette.size());
+        palette.push_back(texture);
+        paletteTextures.push_back(resolved);
+        paletteLookup.emplace(texture.getHandle().getValue(), index);
+        return index;
+    }
+    
+    // 计算[minPixel, maxPixel]覆盖的瓦片下标范围，结果裁剪到[0, count)
+    void visibleRange(float minPixel, float maxPixel, int count, int& first, int& last) const {
+        first = std::max(0, static_cast<int>(std::ceil(minPixel / tileSize)));
+        last = std::min(count - 1, static_cast<int>(std::floor(maxPixel / tileSize)));
+    }
     
 public:
     TileMap(int width, int height, int tileSizePx = 32) 
-        : mapWidth(width), mapHeight(height), tileSize(tileSizePx) {
-        tiles.resize(height, std::vector<TileData>(width));
+        : mapWidth(width), mapHeight(height),
+          chunksX((width + CHUNK_SIZE - 1) / CHUNK_SIZE),
+          chunksY((height + CHUNK_SIZE - 1) / CHUNK_SIZE),
+          tileSize(tileSizePx), viewWidth(1920), viewHeight(1080) {
+        tiles.assign(static_cast<size_t>(chunksX) * chunksY * CHUNK_TILES, EMPTY_TILE);
+        palette.emplace_back();
+        paletteTextures.push_back(nullptr);
     }
     
     void setTile(int x, int y, const std::string& textureName) {
         if (x >= 0 && x < mapWidth && y >= 0 && y < mapHeight) {
-            tiles[y][x].texture = TextureManager::getInstance().getTexture(textureName);
-            tiles[y][x].gridX = x;
-            tiles[y][x].gridY = y;
+            tiles[tileOffset(x, y)] = paletteIndexFor(TextureRef(textureName));
+        }
+    }
+    
+    // 使用已解析的句柄设置瓦片，避免重复哈希纹理名称；句柄无效或已释放时清空该瓦片
+    void setTile(int x, int y, TextureHandle textureHandle) {
+        if (x >= 0 && x < mapWidth && y >= 0 && y < mapHeight) {
+            auto it = paletteLookup.find(textureHandle.getValue());
+            tiles[tileOffset(x, y)] = it != paletteLookup.end()
+                ? it->second : paletteIndexFor(TextureRef(textureHandle));
+        }
+    }
+    
+    void clearTile(int x, int y) {
+        if (x >= 0 && x < mapWidth && y >= 0 && y < mapHeight) {
+            tiles[tileOffset(x, y)] = EMPTY_TILE;
         }
     }
     
+    // 返回瓦片的调色板索引，越界或空瓦片返回EMPTY_TILE
+    uint16_t getTile(int x, int y) const {
+        if (x >= 0 && x < mapWidth && y >= 0 && y < mapHeight) {
+            return tiles[tileOffset(x, y)];
+        }
+        return EMPTY_TILE;
+    }
+    
+    void setViewportSize(float width, float height) {
+        viewWidth = width;
+        viewHeight = height;
+    }
+    
     void render(float cameraX, float cameraY) const {
-        for (int y = 0; y < mapHeight; ++y) {
-            for (int x = 0; x < mapWidth; ++x) {
-                if (tiles[y][x].texture) {
-                    float worldX = x * tileSize - cameraX;
+        forEachVisibleTile(cameraX, cameraY, [this](uint16_t index, float worldX, float worldY) {
+            paletteTextures[index]->render(worldX, worldY, 1.0f, 0.0f);
+        });
+    }
+    
+    // 追加可见瓦片到批量绘制列表
+    void render(float cameraX, float cameraY, std::vector<SpriteInstance>& out, uint32_t layer = 0) const {
+        forEachVisibleTile(cameraX, cameraY, [&](uint16_t index, float worldX, float worldY) {
+            out.push_back({worldX, worldY, 1.0f, 0.0f, palette[index].getHandle(), layer});
+        });
+    }
+    
+    // 遍历屏幕范围内的非空瓦片：fn(调色板索引, 屏幕x, 屏幕y)
+    template<typename Fn>
+    void forEachVisibleTile(float cameraX, float cameraY, Fn&& fn) const {
+        // 只访问在屏幕范围内（含一格边距）的瓦片
+        int firstX, lastX, firstY, lastY;
+        visibleRange(cameraX - tileSize, cameraX + viewWidth + tileSize, mapWidth, firstX, lastX);
+        visibleRange(cameraY - tileSize, cameraY + viewHeight + tileSize, mapHeight, firstY, lastY);
+        if (firstX > lastX || firstY > lastY) {
+            return;
+        }
+        
+        // 逐块遍历，块内按行连续访问
+        for (int cy = firstY / CHUNK_SIZE; cy <= lastY / CHUNK_SIZE; ++cy) {
+            int y0 = std::max(firstY, cy * CHUNK_SIZE);
+            int y1 = std::min(lastY, cy * CHUNK_SIZE + CHUNK_SIZE - 1);
+            for (int cx = firstX / CHUNK_SIZE; cx <= lastX / CHUNK_SIZE; ++cx) {
+                int x0 = std::max(firstX, cx * CHUNK_SIZE);
+                int x1 = std::min(lastX, cx * CHUNK_SIZE + CHUNK_SIZE - 1);
+                const uint16_t* chunk = &tiles[(static_cast<size_t>(cy) * chunksX + cx) * CHUNK_TILES];
+                
+                for (int y = y0; y <= y1; ++y) {
+                    const uint16_t* row = chunk + (y % CHUNK_SIZE) * CHUNK_SIZE;
                     float worldY = y * tileSize - cameraY;
-                    
-                    // 只渲染在屏幕范围内的瓦片
-                    if (worldX >= -tileSize && worldX <= 1920 + tileSize &&
-                        worldY >= -tileSize && worldY <= 1080 + tileSize) {
-                        tiles[y][x].texture->render(worldX, worldY, 1.0f, 0.0f);
+                    for (int x = x0; x <= x1; ++x) {
+                        uint16_t index = row[x % CHUNK_SIZE];
+                        if (index != EMPTY_TILE) {
+                            fn(index, x * tileSize - cameraX, worldY);
+                        }
                     }
                 }
             }
@@ -227,17 +801,24 @@ public:
     }
     
     void generateRandomMap() {
-        std::vector<std::string> tileTypes = {
-            "grass.png", "stone.png", "water.png", "sand.png"
-        };
+        std::vector<TextureRef> tileTypes;
+        for (const char* name : {"grass.png", "stone.png", "water.png", "sand.png"}) {
+            tileTypes.emplace_back(name);
+        }
         
         for (int y = 0; y < mapHeight; ++y) {
             for (int x = 0; x < mapWidth; ++x) {
                 int randomIndex = rand() % tileTypes.size();
-                setTile(x, y, tileTypes[randomIndex]);
+                setTile(x, y, tileTypes[randomIndex].getHandle());
             }
         }
     }
+    
+    int getWidth() const { return mapWidth; }
+    int getHeight() const { return mapHeight; }
+    size_t getTileCount() const { return static_cast<size_t>(mapWidth) * mapHeight; }
+    size_t getPaletteSize() const { return palette.size() - 1; }
+    size_t getTileMemoryBytes() const { return tiles.size() * sizeof(uint16_t); }
 };
 
 // 游戏世界 - 展示享元模式的效果
@@ -246,10 +827,16 @@ private:
     std::unique_ptr<TileMap> tileMap;
     std::unique_ptr<ParticleSystem> fireParticles;
     std::unique_ptr<ParticleSystem> waterParticles;
-    std::vector<std::unique_ptr<SpriteEntity>> enemies;
+    
+    // 敌人同样以SoA形式存放，与粒子共用积分内核
+    static constexpr size_t ENEMY_COUNT = 1000;
+    TextureRef enemyTexture;
+    ParticlePool enemies;
     
 public:
-    GameWorld() {
+    GameWorld()
+        : enemyTexture("goblin.png"),
+          enemies(ENEMY_COUNT) {
         // 创建100x100的瓦片地图
         tileMap = std::make_unique<TileMap>(100, 100);
         tileMap->generateRandomMap();
@@ -259,12 +846,13 @@ public:
         waterParticles = std::make_unique<ParticleSystem>("water_particle.png");
         
         // 创建大量敌人，它们共享相同的纹理享元
-        for (int i = 0; i < 1000; ++i) {
-            auto enemy = std::make_unique<SpriteEntity>("goblin.png", 
-                                                 rand() % 3200, rand() % 3200);
-            enemy->setVelocity((rand() % 100 - 50) / 10.0f, 
-                              (rand() % 100 - 50) / 10.0f);
-            enemies.push_back(std::move(enemy));
+        for (size_t i = 0; i < ENEMY_COUNT; ++i) {
+            float x = rand() % 3200;
+            float y = rand() % 3200;
+            enemies.spawn(x, y,
+                          (rand() % 100 - 50) / 10.0f,
+                          (rand() % 100 - 50) / 10.0f,
+                          1.0f);
         }
     }
     
@@ -279,9 +867,7 @@ public:
         fireParticles->update(deltaTime);
         waterParticles->update(deltaTime);
         
-        for (auto& enemy : enemies) {
-            enemy->update(deltaTime);
-        }
+        enemies.integrate(deltaTime);
     }
     
     void render(float cameraX, float cameraY) const {
@@ -289,8 +875,23 @@ public:
         fireParticles->render();
         waterParticles->render();
         
-        for (const auto& enemy : enemies) {
-            enemy->render();
+        const SpriteTexture* goblinTexture = enemyTexture.get();
+        for (size_t i = 0; i < enemies.size(); ++i) {
+            goblinTexture->render(enemies.getX(i), enemies.getY(i),
+                                 enemies.getScale(i), enemies.getRotation(i));
+        }
+    }
+    
+    // 收集本帧所有精灵到批量绘制列表：瓦片、粒子、敌人依次分层
+    void render(float cameraX, float cameraY, std::vector<SpriteInstance>& out) const {
+        tileMap->render(cameraX, cameraY, out, 0);
+        fireParticles->render(out, 1);
+        waterParticles->render(out, 1);
+        
+        TextureHandle goblinHandle = enemyTexture.getHandle();
+        for (size_t i = 0; i < enemies.size(); ++i) {
+            out.push_back({enemies.getX(i), enemies.getY(i),
+                           enemies.getScale(i), enemies.getRotation(i), goblinHandle, 2});
         }
     }
     
@@ -299,7 +900,7 @@ public:
         size_t totalSprites = enemies.size() + 
                              fireParticles->getParticleCount() + 
                              waterParticles->getParticleCount() + 
-                             100 * 100;  // 瓦片数量
+                             tileMap->getTileCount();
         
         // 在控制台输出内存使用情况
         // printf("纹理享元数量: %zu\n", textureCount);
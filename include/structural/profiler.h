@@ -0,0 +1,528 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <new>
+
+/**
+ * 帧性能剖析 - GameEngineFacade的插桩层
+ * PROFILE_ZONE/PROFILE_SUBSYSTEM在作用域结束时把一段[开始, 结束)时间写入当前线程的环形缓冲区，
+ * PROFILE_COUNT累加当前线程的计数器。写入端只碰本线程的数据，没有锁也没有原子读改写；
+ * 读取端（帧结束汇总、导出）在注册表锁下遍历所有线程的缓冲区。
+ * 定义PATTERN_PROFILING=0时全部宏展开为空，插桩代码完全去除
+ */
+
+#ifndef PATTERN_PROFILING
+#define PATTERN_PROFILING 1
+#endif
+
+// 计数器
+enum class ProfileCounter : uint8_t {
+    Allocations,
+    DrawCalls,
+    EventsDispatched,
+    ObserverNotifications,
+    Count
+};
+
+constexpr size_t PROFILE_COUNTER_COUNT = static_cast<size_t>(ProfileCounter::Count);
+
+constexpr const char* PROFILE_COUNTER_NAMES[PROFILE_COUNTER_COUNT] = {
+    "allocations", "drawCalls", "eventsDispatched", "observerNotifications"
+};
+
+// 子系统 - 每个子系统每帧累计的时间进入滚动直方图
+// 子系统时间是包含式的：嵌套在其他子系统区间里的部分会在两边都计入
+enum class ProfileSubsystem : uint8_t {
+    Input,
+    Physics,
+    Collision,
+    Rendering,
+    Events,
+    AI,
+    Count
+};
+
+constexpr size_t PROFILE_SUBSYSTEM_COUNT = static_cast<size_t>(ProfileSubsystem::Count);
+
+constexpr const char* PROFILE_SUBSYSTEM_NAMES[PROFILE_SUBSYSTEM_COUNT] = {
+    "input", "physics", "collision", "rendering", "events", "ai"
+};
+
+// 滚动直方图 - 保留最近WINDOW个样本（微秒），按固定桶增量计数
+class RollingHistogram {
+public:
+    static constexpr size_t WINDOW = 600;   // 60FPS下约10秒
+    static constexpr size_t BUCKET_COUNT = 10;
+    // 桶上界（微秒），最后一个桶收纳所有更大的值
+    static constexpr uint32_t BUCKET_LIMITS[BUCKET_COUNT - 1] = {
+        100, 250, 500, 1000, 2000, 4000, 8000, 16667, 33333
+    };
+
+private:
+    uint32_t samples[WINDOW] = {};
+    size_t sampleCount = 0;
+    size_t nextSample = 0;
+    uint32_t bucketCounts[BUCKET_COUNT] = {};
+    
+    static size_t bucketOf(uint32_t micros) {
+        return static_cast<size_t>(std::upper_bound(BUCKET_LIMITS, BUCKET_LIMITS + BUCKET_COUNT - 1, micros) - BUCKET_LIMITS);
+    }
+
+public:
+    void add(uint32_t micros) {
+        if (sampleCount == WINDOW) {
+            --bucketCounts[bucketOf(samples[nextSample])];
+        } else {
+            ++sampleCount;
+        }
+        samples[nextSample] = micros;
+        ++bucketCounts[bucketOf(micros)];
+        nextSample = (nextSample + 1) % WINDOW;
+    }
+    
+    size_t getSampleCount() const { return sampleCount; }
+    uint32_t getBucketCount(size_t bucket) const { return bucketCounts[bucket]; }
+    
+    // 百分位（0~100），没有样本时为0
+    uint32_t percentile(double p) const {
+        if (sampleCount == 0) {
+            return 0;
+        }
+        std::vector<uint32_t> sorted(samples, samples + sampleCount);
+        size_t rank = std::min(sampleCount - 1, static_cast<size_t>(p / 100.0 * (sampleCount - 1) + 0.5));
+        std::nth_element(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(rank), sorted.end());
+        return sorted[rank];
+    }
+    
+    uint32_t max() const {
+        return sampleCount ? *std::max_element(samples, samples + sampleCount) : 0;
+    }
+};
+
+// 单个线程的剖析数据，只有所属线程写入
+// 区间事件的字段用relaxed原子存取（编译后就是普通读写），导出线程据此检测被覆盖的条目
+class ProfileThreadBuffer {
+public:
+    static constexpr size_t CAPACITY = 8192;   // 必须是2的幂
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY必须是2的幂");
+    
+    struct ZoneEvent {
+        std::atomic<const char*> name{nullptr};
+        std::atomic<uint64_t> start{0};
+        std::atomic<uint64_t> end{0};
+    };
+    
+    struct ZoneSnapshot {
+        const char* name;
+        uint64_t start;
+        uint64_t end;
+    };
+
+private:
+    ZoneEvent events[CAPACITY];
+    std::atomic<uint64_t> written{0};   // 已发布的事件总数
+    std::atomic<uint64_t> counters[PROFILE_COUNTER_COUNT] = {};
+    std::atomic<uint64_t> subsystemNanos[PROFILE_SUBSYSTEM_COUNT] = {};
+    uint32_t threadIndex;
+    
+    // 单写者：读-加-写即可，不需要读改写指令
+    static void bump(std::atomic<uint64_t>& value, uint64_t amount) {
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+public:
+    explicit ProfileThreadBuffer(uint32_t index) : threadIndex(index) {}
+    
+    void recordZone(const char* name, uint64_t start, uint64_t end) {
+        uint64_t index = written.load(std::memory_order_relaxed);
+        ZoneEvent& event = events[index & (CAPACITY - 1)];
+        event.name.store(name, std::memory_order_relaxed);
+        event.start.store(start, std::memory_order_relaxed);
+        event.end.store(end, std::memory_order_relaxed);
+        written.store(index + 1, std::memory_order_release);
+    }
+    
+    void addCounter(ProfileCounter counter, uint64_t amount) {
+        bump(counters[static_cast<size_t>(counter)], amount);
+    }
+    
+    void addSubsystemTime(ProfileSubsystem subsystem, uint64_t nanos) {
+        bump(subsystemNanos[static_cast<size_t>(subsystem)], nanos);
+    }
+    
+    uint64_t getCounter(size_t counter) const { return counters[counter].load(std::memory_order_relaxed); }
+    uint64_t getSubsystemNanos(size_t subsystem) const { return subsystemNanos[subsystem].load(std::memory_order_relaxed); }
+    uint32_t getThreadIndex() const { return threadIndex; }
+    
+    // 复制当前仍在缓冲区中的事件；复制期间被写入端覆盖的条目会被丢弃
+    void snapshot(std::vector<ZoneSnapshot>& out) const {
+        uint64_t end = written.load(std::memory_order_acquire);
+        uint64_t begin = end > CAPACITY ? end - CAPACITY : 0;
+        size_t first = out.size();
+        for (uint64_t i = begin; i < end; ++i) {
+            const ZoneEvent& event = events[i & (CAPACITY - 1)];
+            out.push_back({event.name.load(std::memory_order_relaxed),
+                           event.start.load(std::memory_order_relaxed),
+                           event.end.load(std::memory_order_relaxed)});
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // 写入端正在写第after个事件时会覆盖第after - CAPACITY个，只保留更新的条目
+        uint64_t after = written.load(std::memory_order_relaxed);
+        uint64_t firstValid = after >= CAPACITY ? after - CAPACITY + 1 : 0;
+        if (firstValid > begin) {
+            size_t dropped = static_cast<size_t>(std::min(firstValid - begin, end - begin));
+            out.erase(out.begin() + static_cast<std::ptrdiff_t>(first),
+                      out.begin() + static_cast<std::ptrdiff_t>(first + dropped));
+        }
+    }
+};
+
+// 剖析器 - 单例，持有所有线程的缓冲区和帧统计
+class Profiler {
+public:
+    struct FrameRecord {
+        uint64_t start;
+        uint64_t end;
+        uint64_t counters[PROFILE_COUNTER_COUNT];
+        uint64_t subsystemNanos[PROFILE_SUBSYSTEM_COUNT];
+    };
+    
+    static constexpr size_t FRAME_HISTORY = RollingHistogram::WINDOW;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    Clock::time_point epoch;
+    std::atomic<bool> enabled{true};
+    
+    mutable std::mutex registryMutex;   // 保护buffers、freeBuffers的增删和遍历
+    std::vector<std::unique_ptr<ProfileThreadBuffer>> buffers;
+    std::vector<ProfileThreadBuffer*> freeBuffers;   // 所属线程已退出、等待复用的缓冲区
+    
+    mutable std::mutex frameMutex;      // 保护以下帧统计
+    uint64_t lastFrameEnd = 0;
+    uint64_t frameCount = 0;
+    uint64_t previousCounters[PROFILE_COUNTER_COUNT] = {};
+    uint64_t previousSubsystemNanos[PROFILE_SUBSYSTEM_COUNT] = {};
+    std::vector<FrameRecord> frames;    // 最近FRAME_HISTORY帧的环形记录
+    RollingHistogram frameHistogram;
+    RollingHistogram subsystemHistograms[PROFILE_SUBSYSTEM_COUNT];
+    
+    Profiler() : epoch(Clock::now()) {
+        frames.reserve(FRAME_HISTORY);
+    }
+    
+    // 优先复用已退出线程留下的缓冲区，缓冲区总数因此不超过同时存活线程数的峰值
+    // 复用时保留累计计数，endFrame按总和求差值仍然正确；旧区间留在环形缓冲中，与新线程共用同一条轨迹
+    ProfileThreadBuffer* registerThread() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        if (!freeBuffers.empty()) {
+            ProfileThreadBuffer* buffer = freeBuffers.back();
+            freeBuffers.pop_back();
+            return buffer;
+        }
+        buffers.push_back(std::make_unique<ProfileThreadBuffer>(static_cast<uint32_t>(buffers.size())));
+        return buffers.back().get();
+    }
+    
+    void releaseThread(ProfileThreadBuffer* buffer) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        freeBuffers.push_back(buffer);
+    }
+    
+    // 线程退出时销毁，把缓冲区交还给剖析器
+    struct ThreadBufferOwner {
+        ProfileThreadBuffer* buffer = nullptr;
+        
+        ~ThreadBufferOwner() {
+            if (buffer) {
+                currentThreadBuffer() = nullptr;
+                getInstance().releaseThread(buffer);
+            }
+        }
+    };
+    
+    static void writeEscaped(std::ostream& out, const char* text) {
+        for (const char* c = text ? text : ""; *c; ++c) {
+            if (*c == '"' || *c == '\\') {
+                out << '\\';
+            }
+            out << *c;
+        }
+    }
+
+public:
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+    
+    static Profiler& getInstance() {
+        static Profiler instance;
+        return instance;
+    }
+    
+    // 当前线程已注册的缓冲区，未注册时为nullptr（常量初始化的线程局部变量，没有初始化检查）
+    static ProfileThreadBuffer*& currentThreadBuffer() {
+        thread_local ProfileThreadBuffer* buffer = nullptr;
+        return buffer;
+    }
+    
+    // 当前线程的缓冲区，第一次调用时注册，线程退出时归还
+    static ProfileThreadBuffer& threadBuffer() {
+        ProfileThreadBuffer*& buffer = currentThreadBuffer();
+        if (!buffer) {
+            thread_local ThreadBufferOwner owner;
+            buffer = getInstance().registerThread();
+            owner.buffer = buffer;
+        }
+        return *buffer;
+    }
+    
+    // 已分配的线程缓冲区数量（含等待复用的）
+    size_t getThreadBufferCount() const {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        return buffers.size();
+    }
+    
+    // 距剖析器创建的纳秒数
+    uint64_t now() const {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count());
+    }
+    
+    // 关闭后区间不再计时，计数器照常累加
+    void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+    
+    static void count(ProfileCounter counter, uint64_t amount = 1) {
+        threadBuffer().addCounter(counter, amount);
+    }
+    
+    // 分配钩子专用：不触发注册（注册本身会分配内存），未注册线程的分配不计入
+    static void countAllocation() {
+        if (ProfileThreadBuffer* buffer = currentThreadBuffer()) {
+            buffer->addCounter(ProfileCounter::Allocations, 1);
+        }
+    }
+    
+    // 每帧结束时在主循环线程调用：汇总各线程的计数器和子系统时间，写入帧记录和直方图
+    void endFrame() {
+        uint64_t frameEnd = now();
+        uint64_t totals[PROFILE_COUNTER_COUNT] = {};
+        uint64_t subsystemTotals[PROFILE_SUBSYSTEM_COUNT] = {};
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            for (const auto& buffer : buffers) {
+                for (size_t c = 0; c < PROFILE_COUNTER_COUNT; ++c) {
+                    totals[c] += buffer->getCounter(c);
+                }
+                for (size_t s = 0; s < PROFILE_SUBSYSTEM_COUNT; ++s) {
+                    subsystemTotals[s] += buffer->getSubsystemNanos(s);
+                }
+            }
+        }
+    
+        std::lock_guard<std::mutex> lock(frameMutex);
+        FrameRecord record{};
+        record.start = lastFrameEnd;
+        record.end = frameEnd;
+        for (size_t c = 0; c < PROFILE_COUNTER_COUNT; ++c) {
+            record.counters[c] = totals[c] - previousCounters[c];
+            previousCounters[c] = totals[c];
+        }
+        for (size_t s = 0; s < PROFILE_SUBSYSTEM_COUNT; ++s) {
+            record.subsystemNanos[s] = subsystemTotals[s] - previousSubsystemNanos[s];
+            previousSubsystemNanos[s] = subsystemTotals[s];
+            subsystemHistograms[s].add(static_cast<uint32_t>(record.subsystemNanos[s] / 1000));
+        }
+        frameHistogram.add(static_cast<uint32_t>((frameEnd - lastFrameEnd) / 1000));
+        if (frames.size() < FRAME_HISTORY) {
+            frames.push_back(record);
+        } else {
+            frames[frameCount % FRAME_HISTORY] = record;
+        }
+        lastFrameEnd = frameEnd;
+        ++frameCount;
+    }
+    
+    uint64_t getFrameCount() const {
+        std::lock_guard<std::mutex> lock(frameMutex);
+        return frameCount;
+    }
+    
+    // 最近一帧的记录，还没有帧时返回false
+    bool getLastFrame(FrameRecord& record) const {
+        std::lock_guard<std::mutex> lock(frameMutex);
+        if (frameCount == 0) {
+            return false;
+        }
+        record = frames[(frameCount - 1) % FRAME_HISTORY];
+        return true;
+    }
+    
+    RollingHistogram getFrameHistogram() const {
+        std::lock_guard<std::mutex> lock(frameMutex);
+        return frameHistogram;
+    }
+    
+    RollingHistogram getSubsystemHistogram(ProfileSubsystem subsystem) const {
+        std::lock_guard<std::mutex> lock(frameMutex);
+        return subsystemHistograms[static_cast<size_t>(subsystem)];
+    }
+    
+    // 导出Chrome Trace事件格式（chrome://tracing、Perfetto可直接打开，Tracy可用import-chrome导入）
+    // 区间为"X"事件，每帧的计数器为"C"事件
+    void writeChromeTrace(std::ostream& out) const {
+        std::vector<ProfileThreadBuffer::ZoneSnapshot> zones;
+        std::vector<std::pair<uint32_t, size_t>> threadRanges;   // (线程编号, zones中的结束位置)
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            for (const auto& buffer : buffers) {
+                buffer->snapshot(zones);
+                threadRanges.emplace_back(buffer->getThreadIndex(), zones.size());
+            }
+        }
+    
+        char number[64];
+        auto micros = [&](uint64_t nanos) {
+            std::snprintf(number, sizeof(number), "%.3f", nanos / 1000.0);
+            return number;
+        };
+    
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"pattern\"}}";
+        size_t begin = 0;
+        for (const auto& range : threadRanges) {
+            out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << range.first
+                << ",\"args\":{\"name\":\"thread " << range.first << "\"}}";
+            for (size_t i = begin; i < range.second; ++i) {
+                out << ",\n{\"name\":\"";
+                writeEscaped(out, zones[i].name);
+                out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << range.first << ",\"ts\":" << micros(zones[i].start);
+                out << ",\"dur\":" << micros(zones[i].end - zones[i].start) << "}";
+            }
+            begin = range.second;
+        }
+    
+        std::lock_guard<std::mutex> lock(frameMutex);
+        size_t frameTotal = frames.size();
+        for (size_t n = 0; n < frameTotal; ++n) {
+            const FrameRecord& frame = frames[(frameCount - frameTotal + n) % FRAME_HISTORY];
+            out << ",\n{\"name\":\"counters\",\"ph\":\"C\",\"pid\":1,\"ts\":" << micros(frame.end) << ",\"args\":{";
+            for (size_t c = 0; c < PROFILE_COUNTER_COUNT; ++c) {
+                out << (c ? "," : "") << "\"" << PROFILE_COUNTER_NAMES[c] << "\":" << frame.counters[c];
+            }
+            out << "}}";
+        }
+        out << "\n]}\n";
+    }
+    
+    bool writeChromeTrace(const std::string& path) const {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        writeChromeTrace(out);
+        return static_cast<bool>(out);
+    }
+    
+    // 文本报告：整帧和各子系统在滚动窗口内的分布
+    std::string formatHistogramReport() const {
+        std::ostringstream report;
+        auto line = [&report](const char* name, const RollingHistogram& histogram) {
+            report << name << ": samples=" << histogram.getSampleCount()
+                   << " p50=" << histogram.percentile(50) << "us"
+                   << " p95=" << histogram.percentile(95) << "us"
+                   << " p99=" << histogram.percentile(99) << "us"
+                   << " max=" << histogram.max() << "us buckets=[";
+            for (size_t b = 0; b < RollingHistogram::BUCKET_COUNT; ++b) {
+                report << (b ? " " : "") << histogram.getBucketCount(b);
+            }
+            report << "]\n";
+        };
+        std::lock_guard<std::mutex> lock(frameMutex);
+        line("frame", frameHistogram);
+        for (size_t s = 0; s < PROFILE_SUBSYSTEM_COUNT; ++s) {
+            line(PROFILE_SUBSYSTEM_NAMES[s], subsystemHistograms[s]);
+        }
+        return report.str();
+    }
+};
+
+// 作用域区间 - 构造时取开始时间，析构时写入当前线程的缓冲区
+// name必须是静态生命周期的字符串（通常是字面量），缓冲区只保存指针
+class ProfileZone {
+private:
+    const char* name;
+    uint64_t start;
+    ProfileSubsystem subsystem;
+    bool active;
+
+public:
+    explicit ProfileZone(const char* zoneName, ProfileSubsystem zoneSubsystem = ProfileSubsystem::Count)
+        : name(zoneName), start(0), subsystem(zoneSubsystem),
+          active(Profiler::getInstance().isEnabled()) {
+        if (active) {
+            start = Profiler::getInstance().now();
+        }
+    }
+    
+    ~ProfileZone() {
+        if (!active) {
+            return;
+        }
+        uint64_t end = Profiler::getInstance().now();
+        ProfileThreadBuffer& buffer = Profiler::threadBuffer();
+        buffer.recordZone(name, start, end);
+        if (subsystem != ProfileSubsystem::Count) {
+            buffer.addSubsystemTime(subsystem, end - start);
+        }
+    }
+    
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+};
+
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+
+#if PATTERN_PROFILING
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_SUBSYSTEM(subsystem, name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name, subsystem)
+#define PROFILE_COUNT(counter, amount) Profiler::count(counter, amount)
+#define PROFILE_FRAME_END() Profiler::getInstance().endFrame()
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_SUBSYSTEM(subsystem, name) ((void)0)
+#define PROFILE_COUNT(counter, amount) ((void)sizeof(amount))
+#define PROFILE_FRAME_END() ((void)0)
+#endif
+
+// 全局分配计数：在恰好一个源文件中写PROFILER_DEFINE_ALLOCATION_HOOKS()，
+// 替换全局operator new/delete，把每次堆分配计入ProfileCounter::Allocations
+#if PATTERN_PROFILING
+#define PROFILER_DEFINE_ALLOCATION_HOOKS() \
+    void* operator new(std::size_t size) { \
+        Profiler::countAllocation(); \
+        if (void* p = std::malloc(size ? size : 1)) { \
+            return p; \
+        } \
+        throw std::bad_alloc(); \
+    } \
+    void* operator new[](std::size_t size) { return operator new(size); } \
+    void operator delete(void* p) noexcept { std::free(p); } \
+    void operator delete[](void* p) noexcept { std::free(p); } \
+    void operator delete(void* p, std::size_t) noexcept { std::free(p); } \
+    void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+#else
+#define PROFILER_DEFINE_ALLOCATION_HOOKS()
+#endif
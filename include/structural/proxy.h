@@ -3,6 +3,36 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include <list>
+#include <deque>
+#include <set>
+#include <filesystem>
+#include <queue>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 /**
  * 代理模式 (Proxy Pattern)
@@ -10,24 +40,470 @@
  * 特点：为另一个对象提供代理以控制对它的访问
  */
 
+// 异步加载优先级，数值越小越先处理
+enum class AssetLoadPriority : uint8_t {
+    Critical,    // 当前帧就要用
+    High,        // 渲染时才发现未加载
+    Normal,      // 关卡预加载
+    Background   // 预测性加载
+};
+
+// 资源异步加载器 - I/O线程池 + 优先级队列
+// 加载和解码在工作线程上完成，完成回调排队，由渲染线程调用pumpCompletions()统一执行，
+// 资源因此只会在两帧之间整体变为可见
+class AssetLoader {
+private:
+    struct Request {
+        AssetLoadPriority priority;
+        uint64_t sequence;
+        std::function<void()> work;
+        std::function<void()> onComplete;
+    };
+    
+    struct RequestOrder {
+        bool operator()(const Request& a, const Request& b) const {
+            if (a.priority != b.priority) {
+                return a.priority > b.priority;
+            }
+            return a.sequence > b.sequence;  // 同优先级先进先出
+        }
+    };
+    
+    std::priority_queue<Request, std::vector<Request>, RequestOrder> requests;
+    std::mutex requestMutex;
+    std::condition_variable requestCondition;
+    bool stopping = false;
+    uint64_t nextSequence = 0;
+    std::vector<std::thread> workers;
+    
+    std::mutex completionMutex;
+    std::vector<std::function<void()>> completions;
+    std::vector<std::function<void()>> draining;
+    std::atomic<size_t> pendingCount{0};
+    
+    void workerLoop() {
+        for (;;) {
+            Request request;
+            {
+                std::unique_lock<std::mutex> lock(requestMutex);
+                requestCondition.wait(lock, [this] { return stopping || !requests.empty(); });
+                if (stopping && requests.empty()) {
+                    return;
+                }
+                request = requests.top();
+                requests.pop();
+            }
+            if (request.work) {
+                request.work();
+            }
+            std::lock_guard<std::mutex> lock(completionMutex);
+            completions.push_back(std::move(request.onComplete));
+        }
+    }
+    
+public:
+    explicit AssetLoader(size_t threadCount = std::max(2u, std::thread::hardware_concurrency() / 2)) {
+        for (size_t i = 0; i < threadCount; ++i) {
+            workers.emplace_back(&AssetLoader::workerLoop, this);
+        }
+    }
+    
+    ~AssetLoader() {
+        {
+            std::lock_guard<std::mutex> lock(requestMutex);
+            stopping = true;
+        }
+        requestCondition.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+    
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+    
+    static AssetLoader& getInstance() {
+        static AssetLoader instance;
+        return instance;
+    }
+    
+    // work在工作线程执行，onComplete在下一次pumpCompletions()时于渲染线程执行
+    void submit(AssetLoadPriority priority, std::function<void()> work, std::function<void()> onComplete) {
+        pendingCount.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(requestMutex);
+            requests.push({priority, nextSequence++, std::move(work), std::move(onComplete)});
+        }
+        requestCondition.notify_one();
+    }
+    
+    // 从任意线程投递一个只在渲染线程执行的回调（用于加载器之外完成的工作）
+    void postCompletion(std::function<void()> onComplete) {
+        pendingCount.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(completionMutex);
+        completions.push_back(std::move(onComplete));
+    }
+    
+    // 渲染线程每帧调用，返回执行的完成回调数量
+    size_t pumpCompletions() {
+        {
+            std::lock_guard<std::mutex> lock(completionMutex);
+            draining.swap(completions);
+        }
+        size_t count = draining.size();
+        for (auto& completion : draining) {
+            if (completion) {
+                completion();
+            }
+        }
+        draining.clear();
+        pendingCount.fetch_sub(count, std::memory_order_relaxed);
+        return count;
+    }
+    
+    // 阻塞直到所有已提交的请求完成（加载界面等场合使用）
+    void finishAll() {
+        while (pendingCount.load(std::memory_order_relaxed) > 0) {
+            if (pumpCompletions() == 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
+    
+    size_t getPendingCount() const { return pendingCount.load(std::memory_order_relaxed); }
+    size_t getThreadCount() const { return workers.size(); }
+};
+
 // 抽象接口 - 游戏资源
 class GameAsset {
 public:
+    using ReadyCallback = std::function<void(GameAsset*)>;
+    
     virtual ~GameAsset() = default;
     virtual void load() = 0;
     virtual void render() = 0;
     virtual bool isLoaded() const = 0;
     virtual size_t getSize() const = 0;
     virtual std::string getName() const = 0;
+    
+    // 请求加载，资源可用后在渲染线程回调；默认实现同步加载
+    virtual void requestLoad(AssetLoadPriority priority = AssetLoadPriority::Normal,
+                             ReadyCallback onReady = nullptr) {
+        (void)priority;
+        load();
+        if (onReady) {
+            onReady(this);
+        }
+    }
+};
+
+// 只读连续视图（C++17没有std::span）
+template <typename T>
+class AssetSpan {
+private:
+    const T* ptr = nullptr;
+    size_t count = 0;
+    
+public:
+    AssetSpan() = default;
+    AssetSpan(const T* data, size_t size) : ptr(data), count(size) {}
+    
+    const T* data() const { return ptr; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const T* begin() const { return ptr; }
+    const T* end() const { return ptr + count; }
+    const T& operator[](size_t i) const { return ptr[i]; }
+};
+
+// 只读内存映射文件，页面在首次访问时才调入
+class MappedFile {
+private:
+    const uint8_t* mappedData = nullptr;
+    size_t mappedSize = 0;
+#ifdef _WIN32
+    HANDLE fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE mappingHandle = nullptr;
+#endif
+    
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+    
+    bool open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(fileHandle, &size) || size.QuadPart == 0) {
+            close();
+            return false;
+        }
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mappingHandle) {
+            close();
+            return false;
+        }
+        mappedData = static_cast<const uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+        if (!mappedData) {
+            close();
+            return false;
+        }
+        mappedSize = static_cast<size_t>(size.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        void* address = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);  // 映射建立后不再需要文件描述符
+        if (address == MAP_FAILED) {
+            return false;
+        }
+        mappedData = static_cast<const uint8_t*>(address);
+        mappedSize = static_cast<size_t>(info.st_size);
+#endif
+        return true;
+    }
+    
+    void close() {
+#ifdef _WIN32
+        if (mappedData) {
+            UnmapViewOfFile(mappedData);
+        }
+        if (mappingHandle) {
+            CloseHandle(mappingHandle);
+        }
+        if (fileHandle != INVALID_HANDLE_VALUE) {
+            CloseHandle(fileHandle);
+        }
+        mappingHandle = nullptr;
+        fileHandle = INVALID_HANDLE_VALUE;
+#else
+        if (mappedData) {
+            munmap(const_cast<uint8_t*>(mappedData), mappedSize);
+        }
+#endif
+        mappedData = nullptr;
+        mappedSize = 0;
+    }
+    
+    const uint8_t* data() const { return mappedData; }
+    size_t size() const { return mappedSize; }
+    bool isOpen() const { return mappedData != nullptr; }
+};
+
+// 打包模型格式 (.pmdl)
+// [头部][对齐填充][顶点区 float × vertexFloatCount][对齐填充][索引区 uint32 × indexCount]
+// 各区按SECTION_ALIGNMENT对齐，映射后可直接当数组使用，无需解析和拷贝；均为小端
+struct PackedModelHeader {
+    static constexpr uint32_t MAGIC = 0x4C444D50;  // "PMDL"
+    static constexpr uint16_t CURRENT_VERSION = 1;
+    static constexpr uint64_t SECTION_ALIGNMENT = 64;
+    
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t floatsPerVertex;     // 顶点步长（位置=3）
+    uint32_t reserved;
+    uint64_t vertexFloatCount;
+    uint64_t indexCount;
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint64_t fileSize;
+};
+
+static_assert(sizeof(PackedModelHeader) == 56, "打包模型头部布局不可改变，修改时提升版本号");
+
+class PackedModelFile {
+private:
+    static uint64_t alignUp(uint64_t value) {
+        uint64_t a = PackedModelHeader::SECTION_ALIGNMENT;
+        return (value + a - 1) / a * a;
+    }
+    
+public:
+    static std::vector<uint8_t> encode(const std::vector<float>& vertices,
+                                       const std::vector<uint32_t>& indices, uint32_t floatsPerVertex = 3) {
+        PackedModelHeader header{};
+        header.magic = PackedModelHeader::MAGIC;
+        header.version = PackedModelHeader::CURRENT_VERSION;
+        header.headerSize = sizeof(PackedModelHeader);
+        header.floatsPerVertex = floatsPerVertex;
+        header.vertexFloatCount = vertices.size();
+        header.indexCount = indices.size();
+        header.vertexOffset = alignUp(sizeof(PackedModelHeader));
+        header.indexOffset = alignUp(header.vertexOffset + vertices.size() * sizeof(float));
+        header.fileSize = header.indexOffset + indices.size() * sizeof(uint32_t);
+        
+        std::vector<uint8_t> bytes(static_cast<size_t>(header.fileSize), 0);
+        std::memcpy(bytes.data(), &header, sizeof(header));
+        if (!vertices.empty()) {
+            std::memcpy(bytes.data() + header.vertexOffset, vertices.data(), vertices.size() * sizeof(float));
+        }
+        if (!indices.empty()) {
+            std::memcpy(bytes.data() + header.indexOffset, indices.data(), indices.size() * sizeof(uint32_t));
+        }
+        return bytes;
+    }
+    
+    static bool write(const std::string& path, const std::vector<float>& vertices,
+                      const std::vector<uint32_t>& indices, uint32_t floatsPerVertex = 3) {
+        std::vector<uint8_t> bytes = encode(vertices, indices, floatsPerVertex);
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return static_cast<bool>(out);
+    }
+    
+    // 校验头部、各区边界、顶点步长以及每个索引都指向有效顶点，失败返回false。
+    // 文件可能来自网络下载，通过校验后getVertices()/getIndices()可以直接交给渲染器
+    static bool validate(const uint8_t* data, size_t size, PackedModelHeader& header) {
+        if (!data || size < sizeof(PackedModelHeader)) {
+            return false;
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (header.magic != PackedModelHeader::MAGIC ||
+            header.version != PackedModelHeader::CURRENT_VERSION ||
+            header.headerSize != sizeof(PackedModelHeader) ||
+            header.fileSize != size) {
+            return false;
+        }
+        uint64_t a = PackedModelHeader::SECTION_ALIGNMENT;
+        if (header.vertexOffset % a != 0 || header.indexOffset % a != 0) {
+            return false;
+        }
+        // 先确认 headerSize <= vertexOffset <= indexOffset <= size，再用区间长度比较数量，避免溢出
+        if (header.vertexOffset < header.headerSize ||
+            header.vertexOffset > header.indexOffset ||
+            header.indexOffset > size) {
+            return false;
+        }
+        if (header.vertexFloatCount > (header.indexOffset - header.vertexOffset) / sizeof(float) ||
+            header.indexCount > (size - header.indexOffset) / sizeof(uint32_t)) {
+            return false;
+        }
+        if (header.floatsPerVertex == 0 || header.vertexFloatCount % header.floatsPerVertex != 0) {
+            return false;
+        }
+        // 加载时一次性检查索引，之后渲染不再逐个判断越界
+        uint64_t vertexCount = header.vertexFloatCount / header.floatsPerVertex;
+        const uint32_t* indices = reinterpret_cast<const uint32_t*>(data + header.indexOffset);
+        for (uint64_t i = 0; i < header.indexCount; ++i) {
+            if (indices[i] >= vertexCount) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// 离线转换工具：.obj -> .pmdl，只保留顶点位置，多边形按扇形三角化
+class PackedModelConverter {
+private:
+    // 解析"7"、"7/2"、"7/2/5"、"-1"等形式的顶点引用，返回从0开始的下标
+    static bool parseIndex(const std::string& token, size_t vertexCount, uint32_t& out) {
+        long value = std::strtol(token.c_str(), nullptr, 10);
+        if (value > 0 && static_cast<size_t>(value) <= vertexCount) {
+            out = static_cast<uint32_t>(value - 1);
+            return true;
+        }
+        if (value < 0 && static_cast<size_t>(-value) <= vertexCount) {
+            out = static_cast<uint32_t>(vertexCount + value);
+            return true;
+        }
+        return false;
+    }
+    
+public:
+    static bool convertObj(const std::string& objPath, const std::string& packedPath) {
+        std::ifstream in(objPath);
+        if (!in) {
+            return false;
+        }
+        std::vector<float> vertices;
+        std::vector<uint32_t> indices;
+        std::vector<uint32_t> face;
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream tokens(line);
+            std::string type;
+            tokens >> type;
+            if (type == "v") {
+                float x = 0, y = 0, z = 0;
+                tokens >> x >> y >> z;
+                vertices.push_back(x);
+                vertices.push_back(y);
+                vertices.push_back(z);
+            } else if (type == "f") {
+                face.clear();
+                std::string token;
+                size_t vertexCount = vertices.size() / 3;
+                while (tokens >> token) {
+                    uint32_t index;
+                    if (!parseIndex(token, vertexCount, index)) {
+                        return false;
+                    }
+                    face.push_back(index);
+                }
+                for (size_t i = 2; i < face.size(); ++i) {
+                    indices.push_back(face[0]);
+                    indices.push_back(face[i - 1]);
+                    indices.push_back(face[i]);
+                }
+            }
+        }
+        return PackedModelFile::write(packedPath, vertices, indices, 3);
+    }
 };
 
 // 真实主题 - 大型3D模型
+// 名字以.pmdl结尾时直接映射打包文件，顶点和索引视图指向映射内存，不分配也不拷贝；
+// 其他情况保持原来的模拟加载
 class LargeModel : public GameAsset {
 private:
     std::string modelName;
     bool loaded;
     size_t fileSize;
     std::vector<float> vertexData;  // 模拟顶点数据
+    MappedFile mapping;
+    AssetSpan<float> vertices;
+    AssetSpan<uint32_t> indices;
+    uint32_t floatsPerVertex = 3;
+    
+    static bool isPackedModel(const std::string& name) {
+        const std::string extension = ".pmdl";
+        return name.size() >= extension.size() &&
+               name.compare(name.size() - extension.size(), extension.size(), extension) == 0;
+    }
+    
+    bool loadPacked() {
+        if (!mapping.open(modelName)) {
+            return false;
+        }
+        PackedModelHeader header;
+        if (!PackedModelFile::validate(mapping.data(), mapping.size(), header)) {
+            mapping.close();
+            return false;
+        }
+        vertices = AssetSpan<float>(reinterpret_cast<const float*>(mapping.data() + header.vertexOffset),
+                                    static_cast<size_t>(header.vertexFloatCount));
+        indices = AssetSpan<uint32_t>(reinterpret_cast<const uint32_t*>(mapping.data() + header.indexOffset),
+                                      static_cast<size_t>(header.indexCount));
+        floatsPerVertex = header.floatsPerVertex;
+        fileSize = mapping.size();
+        return true;
+    }
     
 public:
     LargeModel(const std::string& name, size_t size) 
@@ -35,11 +511,17 @@ public:
     
     void load() override {
         if (!loaded) {
+            if (isPackedModel(modelName)) {
+                loaded = loadPacked();
+                return;
+            }
+            
             // 模拟加载大型文件的耗时过程
             // loadFromFile(modelName);
             
             // 模拟分配大量内存
             vertexData.resize(fileSize / sizeof(float));
+            vertices = AssetSpan<float>(vertexData.data(), vertexData.size());
             
             loaded = true;
             // 输出加载信息
@@ -49,27 +531,72 @@ public:
     void render() override {
         if (loaded) {
             // 渲染3D模型
-            // renderModel(vertexData);
+            // renderModel(vertices, indices);
         }
     }
     
     bool isLoaded() const override { return loaded; }
     size_t getSize() const override { return fileSize; }
     std::string getName() const override { return modelName; }
+    
+    AssetSpan<float> getVertices() const { return vertices; }
+    AssetSpan<uint32_t> getIndices() const { return indices; }
+    uint32_t getFloatsPerVertex() const { return floatsPerVertex; }
+    bool isMapped() const { return mapping.isOpen(); }
 };
 
 // 代理 - 虚拟代理（懒加载代理）
+// 首次渲染时不再同步加载，而是提交异步请求并先渲染占位符；
+// 模型在工作线程加载完成后，由渲染线程在pumpCompletions()中一次性换上。
+// 加载失败（文件缺失或格式无效）后记为失败状态，不再每帧重新提交，需要时调用retryLoad()
 class ModelProxy : public GameAsset {
 private:
+    // 与加载任务共享的状态；代理先销毁时标记取消，完成回调不再访问代理
+    struct LoadTicket {
+        std::atomic<bool> cancelled{false};
+        std::unique_ptr<LargeModel> result;
+    };
+    
     std::unique_ptr<LargeModel> realModel;
     std::string modelName;
     size_t modelSize;
     bool loadRequested;
+    bool loadFailed = false;
+    AssetLoader* loader;
+    std::shared_ptr<LoadTicket> pendingLoad;
+    std::vector<ReadyCallback> readyCallbacks;
+    
+    // 成功和失败都会回调，回调中用isLoaded()/hasLoadFailed()区分
+    void publish(std::unique_ptr<LargeModel> model) {
+        if (!realModel || !realModel->isLoaded()) {
+            realModel = std::move(model);
+        }
+        loadRequested = true;
+        loadFailed = !isLoaded();
+        auto callbacks = std::move(readyCallbacks);
+        readyCallbacks.clear();
+        for (auto& callback : callbacks) {
+            callback(this);
+        }
+    }
+    
+    void renderPlaceholder() {
+        // 渲染低模或包围盒占位
+        // renderBoundingBox(modelName);
+    }
     
 public:
-    ModelProxy(const std::string& name, size_t size) 
-        : modelName(name), modelSize(size), loadRequested(false) {}
+    ModelProxy(const std::string& name, size_t size, AssetLoader* assetLoader = nullptr) 
+        : modelName(name), modelSize(size), loadRequested(false),
+          loader(assetLoader ? assetLoader : &AssetLoader::getInstance()) {}
+    
+    ~ModelProxy() {
+        if (pendingLoad) {
+            pendingLoad->cancelled.store(true, std::memory_order_relaxed);
+        }
+    }
     
+    // 同步加载，异步请求仍在进行时其结果会被丢弃
     void load() override {
         if (!realModel) {
             realModel = std::make_unique<LargeModel>(modelName, modelSize);
@@ -77,13 +604,66 @@ public:
         if (!loadRequested) {
             realModel->load();
             loadRequested = true;
+            loadFailed = !realModel->isLoaded();
+        }
+    }
+    
+    // 已加载或已失败时立即回调，不重复提交
+    void requestLoad(AssetLoadPriority priority = AssetLoadPriority::Normal,
+                     ReadyCallback onReady = nullptr) override {
+        if (isLoaded() || loadFailed) {
+            if (onReady) {
+                onReady(this);
+            }
+            return;
+        }
+        if (onReady) {
+            readyCallbacks.push_back(std::move(onReady));
+        }
+        if (pendingLoad) {
+            return;
+        }
+        auto ticket = std::make_shared<LoadTicket>();
+        pendingLoad = ticket;
+        std::string name = modelName;
+        size_t size = modelSize;
+        loader->submit(priority,
+            [ticket, name, size] {
+                if (ticket->cancelled.load(std::memory_order_relaxed)) {
+                    return;
+                }
+                auto model = std::make_unique<LargeModel>(name, size);
+                model->load();
+                ticket->result = std::move(model);
+            },
+            [this, ticket] {
+                if (ticket->cancelled.load(std::memory_order_relaxed)) {
+                    return;
+                }
+                pendingLoad.reset();
+                publish(std::move(ticket->result));
+            });
+    }
+    
+    // 清除失败状态并重新提交异步加载
+    void retryLoad(AssetLoadPriority priority = AssetLoadPriority::Normal,
+                   ReadyCallback onReady = nullptr) {
+        if (loadFailed) {
+            loadFailed = false;
+            loadRequested = false;
+            realModel.reset();
         }
+        requestLoad(priority, std::move(onReady));
     }
     
     void render() override {
-        // 按需加载：只有在渲染时才真正加载模型
-        if (!realModel) {
-            load();
+        // 按需加载：首次渲染时发起高优先级异步加载，就绪前（或加载失败后）渲染占位符
+        if (!isLoaded()) {
+            if (!loadFailed) {
+                requestLoad(AssetLoadPriority::High);
+            }
+            renderPlaceholder();
+            return;
         }
         realModel->render();
     }
@@ -92,6 +672,9 @@ public:
         return realModel && realModel->isLoaded();
     }
     
+    bool isLoading() const { return pendingLoad != nullptr; }
+    bool hasLoadFailed() const { return loadFailed; }
+    
     size_t getSize() const override { return modelSize; }
     std::string getName() const override { return modelName; }
 };
@@ -140,35 +723,184 @@ public:
     }
 };
 
+// 资源驻留统计
+struct AssetResidencyStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t residentBytes = 0;
+    size_t budgetBytes = 0;
+    size_t residentCount = 0;
+    size_t pinnedCount = 0;
+};
+
+// 资源驻留管理器 - 按字节预算缓存资源
+// 正在被代理使用的资源处于固定状态，不会被淘汰；最后一个使用者释放后进入LRU队列，
+// 只有总字节数超过预算时才从最久未使用的一端淘汰。线程安全
+class AssetResidencyManager {
+private:
+    struct Entry {
+        std::shared_ptr<GameAsset> asset;
+        size_t bytes;
+        uint32_t pinCount;
+        std::list<std::string>::iterator lruPosition;
+    };
+    
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> lruList;  // 未固定的资源，队首最近使用
+    size_t budgetBytes;
+    size_t residentBytes = 0;
+    size_t pinnedCount = 0;
+    AssetResidencyStats counters;
+    
+    // 调用方需持有mutex
+    void evictOverBudget() {
+        while (residentBytes > budgetBytes && !lruList.empty()) {
+            auto it = entries.find(lruList.back());
+            lruList.pop_back();
+            residentBytes -= it->second.bytes;
+            entries.erase(it);
+            counters.evictions++;
+        }
+    }
+    
+    // 调用方需持有mutex
+    void pin(Entry& entry) {
+        if (entry.pinCount++ == 0) {
+            lruList.erase(entry.lruPosition);
+            pinnedCount++;
+        }
+    }
+    
+public:
+    explicit AssetResidencyManager(size_t budget = 256 * 1024 * 1024) : budgetBytes(budget) {}
+    
+    static AssetResidencyManager& getInstance() {
+        static AssetResidencyManager instance;
+        return instance;
+    }
+    
+    // 获取并固定资源，不在缓存中时用factory创建
+    // factory在锁外调用，慢速加载不会阻塞其他资源的acquire/release；
+    // 同名资源并发未命中时以先插入者为准，其余创建的实例直接丢弃
+    std::shared_ptr<GameAsset> acquire(const std::string& name,
+                                       const std::function<std::shared_ptr<GameAsset>()>& factory) {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto it = entries.find(name);
+        if (it != entries.end()) {
+            counters.hits++;
+            pin(it->second);
+            return it->second.asset;
+        }
+        counters.misses++;
+        lock.unlock();
+        
+        std::shared_ptr<GameAsset> asset = factory();
+        size_t bytes = asset->getSize();
+        
+        lock.lock();
+        auto inserted = entries.try_emplace(name, Entry{asset, bytes, 1, lruList.end()});
+        Entry& entry = inserted.first->second;
+        if (!inserted.second) {
+            pin(entry);
+            return entry.asset;
+        }
+        residentBytes += bytes;
+        pinnedCount++;
+        evictOverBudget();
+        return asset;
+    }
+    
+    std::shared_ptr<GameAsset> acquire(const std::string& name, size_t size) {
+        return acquire(name, [&name, size] { return std::make_shared<LargeModel>(name, size); });
+    }
+    
+    // 解除固定；最后一个使用者释放后资源仍留在缓存中，直到超出预算被淘汰
+    void release(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(name);
+        if (it == entries.end() || it->second.pinCount == 0) {
+            return;
+        }
+        Entry& entry = it->second;
+        if (--entry.pinCount == 0) {
+            lruList.push_front(name);
+            entry.lruPosition = lruList.begin();
+            pinnedCount--;
+            evictOverBudget();
+        }
+    }
+    
+    // 资源实际大小变化（如加载后）时更新字节计数
+    void updateSize(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(name);
+        if (it != entries.end()) {
+            size_t bytes = it->second.asset->getSize();
+            residentBytes = residentBytes - it->second.bytes + bytes;
+            it->second.bytes = bytes;
+            evictOverBudget();
+        }
+    }
+    
+    void setBudget(size_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        budgetBytes = bytes;
+        evictOverBudget();
+    }
+    
+    // 淘汰所有未固定的资源
+    void trim() {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t savedBudget = budgetBytes;
+        budgetBytes = 0;
+        evictOverBudget();
+        budgetBytes = savedBudget;
+    }
+    
+    bool isResident(const std::string& name) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.count(name) != 0;
+    }
+    
+    AssetResidencyStats getStats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        AssetResidencyStats stats = counters;
+        stats.residentBytes = residentBytes;
+        stats.budgetBytes = budgetBytes;
+        stats.residentCount = entries.size();
+        stats.pinnedCount = pinnedCount;
+        return stats;
+    }
+    
+    void resetCounters() {
+        std::lock_guard<std::mutex> lock(mutex);
+        counters = AssetResidencyStats();
+    }
+};
+
 // 智能引用代理 - 引用计数和缓存
+// 资源由AssetResidencyManager持有：代理存在期间资源被固定，
+// 代理销毁后资源仍然驻留，跨越流式加载区域边界时不会立即被销毁再重新加载
 class SmartAssetProxy : public GameAsset {
 private:
-    static std::unordered_map<std::string, std::weak_ptr<GameAsset>> assetCache;
     std::shared_ptr<GameAsset> realAsset;
     std::string assetName;
-    size_t referenceCount;
+    AssetResidencyManager& residency;
     
 public:
-    SmartAssetProxy(const std::string& name, size_t size) 
-        : assetName(name), referenceCount(0) {
-        
-        // 检查缓存中是否已存在该资源
-        auto it = assetCache.find(name);
-        if (it != assetCache.end()) {
-            auto cachedAsset = it->second.lock();
-            if (cachedAsset) {
-                realAsset = cachedAsset;
-                return;
-            }
-        }
-        
-        // 创建新资源并加入缓存
-        realAsset = std::make_shared<LargeModel>(name, size);
-        assetCache[name] = realAsset;
+    SmartAssetProxy(const std::string& name, size_t size,
+                    AssetResidencyManager& manager = AssetResidencyManager::getInstance()) 
+        : assetName(name), residency(manager) {
+        // 命中缓存时直接复用，否则创建新资源并加入缓存
+        realAsset = residency.acquire(name, size);
     }
     
+    SmartAssetProxy(const SmartAssetProxy&) = delete;
+    SmartAssetProxy& operator=(const SmartAssetProxy&) = delete;
+    
     void load() override {
-        referenceCount++;
         realAsset->load();
     }
     
@@ -189,37 +921,562 @@ public:
     }
     
     ~SmartAssetProxy() {
-        // 析构时减少引用计数
-        referenceCount--;
-        if (referenceCount == 0) {
-            // 可以选择从缓存中移除
+        // 析构时解除固定，资源交给驻留管理器按预算淘汰
+        residency.release(assetName);
+    }
+};
+
+// 远程资源信息（HEAD请求的结果）
+struct RemoteAssetInfo {
+    uint64_t size = 0;
+    std::string etag;
+};
+
+// 传输层接口 - 支持HEAD和Range请求的HTTP客户端实现它（如基于libcurl）
+// 可以被多个下载线程同时调用
+class AssetTransport {
+public:
+    virtual ~AssetTransport() = default;
+    virtual bool head(const std::string& url, RemoteAssetInfo& info) = 0;
+    // 请求[offset, offset + length)，成功时out恰好包含length字节
+    virtual bool fetchRange(const std::string& url, uint64_t offset, uint64_t length,
+                            std::vector<uint8_t>& out) = 0;
+};
+
+// 64位FNV-1a哈希，用于缓存键和内容校验
+class AssetHash {
+public:
+    static constexpr uint64_t OFFSET_BASIS = 14695981039346656037ull;
+    static constexpr uint64_t PRIME = 1099511628211ull;
+    
+    static uint64_t update(uint64_t hash, const uint8_t* data, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= data[i];
+            hash *= PRIME;
+        }
+        return hash;
+    }
+    
+    static uint64_t of(const std::string& text) {
+        return update(OFFSET_BASIS, reinterpret_cast<const uint8_t*>(text.data()), text.size());
+    }
+    
+    static bool ofFile(const std::string& path, uint64_t& hash) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            return false;
+        }
+        hash = OFFSET_BASIS;
+        std::vector<char> buffer(1 << 16);
+        while (in) {
+            in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            hash = update(hash, reinterpret_cast<const uint8_t*>(buffer.data()), static_cast<size_t>(in.gcount()));
+        }
+        return true;
+    }
+    
+    static std::string toHex(uint64_t value) {
+        char text[17];
+        std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(value));
+        return text;
+    }
+};
+
+// 模拟传输层 - 为每个URL生成确定性的打包模型内容，没有真实网络时使用
+class SimulatedAssetTransport : public AssetTransport {
+private:
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<const std::vector<uint8_t>>> contents;
+    size_t modelBytes;
+    
+    std::shared_ptr<const std::vector<uint8_t>> contentFor(const std::string& url) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = contents.find(url);
+        if (it != contents.end()) {
+            return it->second;
+        }
+        uint64_t seed = AssetHash::of(url);
+        std::vector<float> vertices(modelBytes / sizeof(float) / 3 * 3);
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+            vertices[i] = static_cast<float>(seed >> 40) / static_cast<float>(1 << 24);
         }
+        std::vector<uint32_t> indices;
+        for (uint32_t v = 0; v + 2 < vertices.size() / 3; v += 3) {
+            indices.push_back(v);
+            indices.push_back(v + 1);
+            indices.push_back(v + 2);
+        }
+        auto bytes = std::make_shared<const std::vector<uint8_t>>(PackedModelFile::encode(vertices, indices));
+        contents[url] = bytes;
+        return bytes;
+    }
+    
+public:
+    explicit SimulatedAssetTransport(size_t bytesPerModel = 1024 * 1024) : modelBytes(bytesPerModel) {}
+    
+    bool head(const std::string& url, RemoteAssetInfo& info) override {
+        auto bytes = contentFor(url);
+        info.size = bytes->size();
+        info.etag = "\"" + AssetHash::toHex(AssetHash::update(AssetHash::OFFSET_BASIS, bytes->data(), bytes->size())) + "\"";
+        return true;
+    }
+    
+    bool fetchRange(const std::string& url, uint64_t offset, uint64_t length,
+                    std::vector<uint8_t>& out) override {
+        auto bytes = contentFor(url);
+        if (offset + length > bytes->size()) {
+            return false;
+        }
+        out.assign(bytes->begin() + static_cast<std::ptrdiff_t>(offset),
+                   bytes->begin() + static_cast<std::ptrdiff_t>(offset + length));
+        return true;
+    }
+};
+
+// 单个下载任务的状态，下载线程更新，其他线程可随时查询进度
+class AssetDownloadTask {
+public:
+    enum class State { Pending, Downloading, Completed, Failed };
+    using Callback = std::function<void(const AssetDownloadTask&)>;
+    
+private:
+    friend class AssetDownloadManager;
+    
+    std::string url;
+    std::string host;
+    std::string urlKey;
+    std::atomic<State> state{State::Pending};
+    std::atomic<uint64_t> totalBytes{0};
+    std::atomic<uint64_t> receivedBytes{0};
+    std::atomic<uint32_t> chunksRemaining{0};
+    uint32_t chunkCount = 0;
+    bool fromCache = false;
+    std::string etag;
+    std::string resultPath;
+    
+    std::mutex fileMutex;              // 串行化对.part和进度文件的写入
+    mutable std::mutex waitMutex;
+    mutable std::condition_variable waitCondition;
+    std::vector<Callback> callbacks;
+    
+public:
+    const std::string& getURL() const { return url; }
+    State getState() const { return state.load(std::memory_order_acquire); }
+    bool isFinished() const {
+        State current = getState();
+        return current == State::Completed || current == State::Failed;
+    }
+    bool succeeded() const { return getState() == State::Completed; }
+    bool isFromCache() const { return fromCache; }
+    uint64_t getTotalBytes() const { return totalBytes.load(std::memory_order_relaxed); }
+    uint64_t getReceivedBytes() const { return receivedBytes.load(std::memory_order_relaxed); }
+    
+    float getProgress() const {
+        uint64_t total = getTotalBytes();
+        return total ? static_cast<float>(getReceivedBytes()) / static_cast<float>(total) : 0.0f;
+    }
+    
+    // 完成后才有效
+    const std::string& getResultPath() const { return resultPath; }
+    
+    void wait() const {
+        std::unique_lock<std::mutex> lock(waitMutex);
+        waitCondition.wait(lock, [this] { return isFinished(); });
     }
 };
 
-std::unordered_map<std::string, std::weak_ptr<GameAsset>> SmartAssetProxy::assetCache;
+// 下载管理器配置
+struct AssetDownloadConfig {
+    uint64_t chunkSize = 1024 * 1024;
+    size_t maxConnectionsPerHost = 4;
+    size_t workerCount = 8;
+    size_t maxRetries = 3;
+    bool verifyCachedContent = false;   // 命中缓存时重新计算内容哈希
+    std::string cacheDirectory = (std::filesystem::temp_directory_path() / "pattern_asset_cache").string();
+};
+
+// 下载管理器 - 分块并行Range下载、按主机限制连接数、内容寻址的磁盘缓存
+// 缓存目录中<内容哈希>.pmdl保存文件内容（相同内容只存一份），<URL哈希>.meta记录
+// ETag、大小和内容哈希；命中时ETag和大小一致即复用。未完成的下载保存在.part文件，
+// 已完成的分块记录在.progress中，重启后ETag未变则只补齐缺失的分块
+class AssetDownloadManager {
+public:
+    using Config = AssetDownloadConfig;
+    
+private:
+    static constexpr uint32_t PROBE_JOB = UINT32_MAX;
+    
+    struct Job {
+        std::shared_ptr<AssetDownloadTask> task;
+        uint32_t chunkIndex;   // PROBE_JOB表示HEAD和缓存检查
+        size_t attempts;
+    };
+    
+    Config config;
+    std::shared_ptr<AssetTransport> transport;
+    
+    std::mutex mutex;
+    std::condition_variable jobCondition;
+    std::deque<Job> jobs;
+    std::unordered_map<std::string, size_t> activeConnections;   // 按主机
+    std::unordered_map<std::string, std::weak_ptr<AssetDownloadTask>> inFlight;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+    
+    static std::string hostOf(const std::string& url) {
+        size_t start = url.find("://");
+        start = start == std::string::npos ? 0 : start + 3;
+        size_t end = url.find('/', start);
+        return url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+    }
+    
+    std::string pathFor(const std::string& name) const {
+        return (std::filesystem::path(config.cacheDirectory) / name).string();
+    }
+    
+    void enqueue(const Job& job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(job);
+        }
+        jobCondition.notify_all();
+    }
+    
+    // 取出第一个所属主机还有空闲连接的任务
+    bool takeJob(Job& job) {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            if (stopping) {
+                return false;
+            }
+            for (auto it = jobs.begin(); it != jobs.end(); ++it) {
+                size_t& active = activeConnections[it->task->host];
+                if (active < config.maxConnectionsPerHost) {
+                    active++;
+                    job = *it;
+                    jobs.erase(it);
+                    return true;
+                }
+            }
+            jobCondition.wait(lock);
+        }
+    }
+    
+    void releaseConnection(const std::string& host) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            activeConnections[host]--;
+        }
+        jobCondition.notify_all();
+    }
+    
+    void finish(const std::shared_ptr<AssetDownloadTask>& task, AssetDownloadTask::State result) {
+        std::vector<AssetDownloadTask::Callback> callbacks;
+        {
+            std::lock_guard<std::mutex> lock(task->waitMutex);
+            task->state.store(result, std::memory_order_release);
+            callbacks.swap(task->callbacks);
+        }
+        task->waitCondition.notify_all();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = inFlight.find(task->url);
+            if (it != inFlight.end() && it->second.lock() == task) {
+                inFlight.erase(it);
+            }
+        }
+        for (auto& callback : callbacks) {
+            callback(*task);
+        }
+    }
+    
+    bool readMeta(const std::string& path, std::string& etag, uint64_t& size, std::string& contentHash) {
+        std::ifstream in(path);
+        return static_cast<bool>(std::getline(in, etag) && in >> size >> contentHash);
+    }
+    
+    // HEAD请求、缓存命中检查、断点续传状态恢复，然后为缺失的分块排队
+    void probe(const std::shared_ptr<AssetDownloadTask>& task) {
+        RemoteAssetInfo info;
+        if (!transport->head(task->url, info) || info.size == 0) {
+            finish(task, AssetDownloadTask::State::Failed);
+            return;
+        }
+        task->etag = info.etag;
+        task->totalBytes.store(info.size, std::memory_order_relaxed);
+        
+        std::string cachedEtag, contentHash;
+        uint64_t cachedSize = 0;
+        if (readMeta(pathFor(task->urlKey + ".meta"), cachedEtag, cachedSize, contentHash) &&
+            !info.etag.empty() && cachedEtag == info.etag && cachedSize == info.size) {
+            std::string dataPath = pathFor(contentHash + ".pmdl");
+            std::error_code ec;
+            bool valid = std::filesystem::file_size(dataPath, ec) == info.size && !ec;
+            if (valid && config.verifyCachedContent) {
+                uint64_t hash = 0;
+                valid = AssetHash::ofFile(dataPath, hash) && AssetHash::toHex(hash) == contentHash;
+            }
+            if (valid) {
+                task->fromCache = true;
+                task->resultPath = dataPath;
+                task->receivedBytes.store(info.size, std::memory_order_relaxed);
+                finish(task, AssetDownloadTask::State::Completed);
+                return;
+            }
+        }
+        
+        task->state.store(AssetDownloadTask::State::Downloading, std::memory_order_release);
+        task->chunkCount = static_cast<uint32_t>((info.size + config.chunkSize - 1) / config.chunkSize);
+        
+        // 恢复之前完成的分块，ETag变了或文件不完整则重新开始
+        std::string partPath = pathFor(task->urlKey + ".part");
+        std::string progressPath = pathFor(task->urlKey + ".progress");
+        std::set<uint32_t> completed;
+        {
+            std::ifstream progress(progressPath);
+            std::string progressEtag;
+            std::error_code ec;
+            if (progress && std::getline(progress, progressEtag) && progressEtag == info.etag &&
+                !info.etag.empty() && std::filesystem::file_size(partPath, ec) == info.size && !ec) {
+                uint32_t index;
+                while (progress >> index) {
+                    if (index < task->chunkCount) {
+                        completed.insert(index);
+                    }
+                }
+            } else {
+                completed.clear();
+            }
+        }
+        if (completed.empty()) {
+            std::ofstream part(partPath, std::ios::binary | std::ios::trunc);
+            part.seekp(static_cast<std::streamoff>(info.size - 1));
+            part.put('\0');
+            std::ofstream progress(progressPath, std::ios::trunc);
+            progress << info.etag << "\n";
+            if (!part || !progress) {
+                finish(task, AssetDownloadTask::State::Failed);
+                return;
+            }
+        }
+        
+        uint64_t resumedBytes = 0;
+        for (uint32_t index : completed) {
+            resumedBytes += std::min<uint64_t>(config.chunkSize, info.size - static_cast<uint64_t>(index) * config.chunkSize);
+        }
+        task->receivedBytes.store(resumedBytes, std::memory_order_relaxed);
+        uint32_t missing = task->chunkCount - static_cast<uint32_t>(completed.size());
+        task->chunksRemaining.store(missing, std::memory_order_release);
+        if (missing == 0) {
+            finalize(task);
+            return;
+        }
+        for (uint32_t index = 0; index < task->chunkCount; ++index) {
+            if (!completed.count(index)) {
+                enqueue({task, index, 0});
+            }
+        }
+    }
+    
+    bool downloadChunk(const std::shared_ptr<AssetDownloadTask>& task, uint32_t index) {
+        uint64_t offset = static_cast<uint64_t>(index) * config.chunkSize;
+        uint64_t length = std::min<uint64_t>(config.chunkSize, task->getTotalBytes() - offset);
+        std::vector<uint8_t> data;
+        if (!transport->fetchRange(task->url, offset, length, data) || data.size() != length) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(task->fileMutex);
+        std::fstream part(pathFor(task->urlKey + ".part"), std::ios::binary | std::ios::in | std::ios::out);
+        part.seekp(static_cast<std::streamoff>(offset));
+        part.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!part) {
+            return false;
+        }
+        part.close();
+        std::ofstream progress(pathFor(task->urlKey + ".progress"), std::ios::app);
+        progress << index << "\n";
+        task->receivedBytes.fetch_add(length, std::memory_order_relaxed);
+        return true;
+    }
+    
+    // 全部分块完成：计算内容哈希，移动到内容寻址位置并写入元数据
+    void finalize(const std::shared_ptr<AssetDownloadTask>& task) {
+        std::string partPath = pathFor(task->urlKey + ".part");
+        uint64_t hash = 0;
+        if (!AssetHash::ofFile(partPath, hash)) {
+            finish(task, AssetDownloadTask::State::Failed);
+            return;
+        }
+        std::string contentHash = AssetHash::toHex(hash);
+        std::string dataPath = pathFor(contentHash + ".pmdl");
+        std::error_code ec;
+        std::filesystem::rename(partPath, dataPath, ec);
+        if (ec) {
+            finish(task, AssetDownloadTask::State::Failed);
+            return;
+        }
+        std::filesystem::remove(pathFor(task->urlKey + ".progress"), ec);
+        {
+            std::ofstream meta(pathFor(task->urlKey + ".meta"), std::ios::trunc);
+            meta << task->etag << "\n" << task->getTotalBytes() << " " << contentHash << "\n";
+        }
+        task->resultPath = dataPath;
+        finish(task, AssetDownloadTask::State::Completed);
+    }
+    
+    void workerLoop() {
+        Job job;
+        while (takeJob(job)) {
+            auto task = job.task;
+            if (job.chunkIndex == PROBE_JOB) {
+                probe(task);
+                releaseConnection(task->host);
+                continue;
+            }
+            bool ok = task->getState() != AssetDownloadTask::State::Failed && downloadChunk(task, job.chunkIndex);
+            releaseConnection(task->host);
+            if (task->getState() == AssetDownloadTask::State::Failed) {
+                continue;   // 其他分块已经失败
+            }
+            if (!ok) {
+                if (++job.attempts < config.maxRetries) {
+                    enqueue(job);
+                } else {
+                    finish(task, AssetDownloadTask::State::Failed);
+                }
+                continue;
+            }
+            if (task->chunksRemaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                finalize(task);
+            }
+        }
+    }
+    
+public:
+    AssetDownloadManager(Config managerConfig = Config(),
+                         std::shared_ptr<AssetTransport> assetTransport = std::make_shared<SimulatedAssetTransport>())
+        : config(std::move(managerConfig)), transport(std::move(assetTransport)) {
+        if (config.chunkSize == 0 || config.maxConnectionsPerHost == 0) {
+            throw std::invalid_argument("下载配置无效：分块大小和每主机连接数必须大于0");
+        }
+        std::error_code ec;
+        std::filesystem::create_directories(config.cacheDirectory, ec);
+        for (size_t i = 0; i < std::max<size_t>(1, config.workerCount); ++i) {
+            workers.emplace_back(&AssetDownloadManager::workerLoop, this);
+        }
+    }
+    
+    // 停止工作线程，队列中尚未完成的任务标记为失败，等待者和回调都会得到结果
+    ~AssetDownloadManager() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        jobCondition.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        std::deque<Job> abandoned;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            abandoned.swap(jobs);
+        }
+        for (const auto& job : abandoned) {
+            if (!job.task->isFinished()) {
+                finish(job.task, AssetDownloadTask::State::Failed);
+            }
+        }
+    }
+    
+    AssetDownloadManager(const AssetDownloadManager&) = delete;
+    AssetDownloadManager& operator=(const AssetDownloadManager&) = delete;
+    
+    static AssetDownloadManager& getInstance() {
+        static AssetDownloadManager instance;
+        return instance;
+    }
+    
+    // 开始下载（同一URL正在下载时复用同一任务）；onFinished在下载线程上调用
+    std::shared_ptr<AssetDownloadTask> download(const std::string& url,
+                                                AssetDownloadTask::Callback onFinished = nullptr) {
+        std::shared_ptr<AssetDownloadTask> task;
+        bool created = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = inFlight.find(url);
+            if (it != inFlight.end()) {
+                task = it->second.lock();
+            }
+            if (!task) {
+                task = std::make_shared<AssetDownloadTask>();
+                task->url = url;
+                task->host = hostOf(url);
+                task->urlKey = AssetHash::toHex(AssetHash::of(url));
+                inFlight[url] = task;
+                created = true;
+            }
+        }
+        if (onFinished) {
+            std::unique_lock<std::mutex> lock(task->waitMutex);
+            if (task->isFinished()) {
+                lock.unlock();
+                onFinished(*task);
+            } else {
+                task->callbacks.push_back(std::move(onFinished));
+            }
+        }
+        if (created) {
+            enqueue({task, PROBE_JOB, 0});
+        }
+        return task;
+    }
+    
+    const Config& getConfig() const { return config; }
+};
 
 // 远程代理 - 网络资源代理
+// 通过AssetDownloadManager分块并行下载到磁盘缓存，完成后按内存映射方式加载打包模型
 class NetworkAssetProxy : public GameAsset {
 private:
+    struct LoadTicket {
+        std::atomic<bool> cancelled{false};
+        std::unique_ptr<LargeModel> result;
+    };
+    
     std::string assetURL;
     std::unique_ptr<GameAsset> localAsset;
     bool downloaded;
+    AssetDownloadManager* downloadManager;
+    AssetLoader* loader;
+    std::shared_ptr<AssetDownloadTask> downloadTask;
+    std::shared_ptr<LoadTicket> pendingLoad;
+    std::vector<ReadyCallback> readyCallbacks;
     
     void downloadAsset() {
         if (!downloaded) {
-            // 模拟从网络下载资源
-            // downloadFromURL(assetURL);
-            
-            // 下载完成后创建本地资源
-            localAsset = std::make_unique<LargeModel>("downloaded_" + assetURL, 1024 * 1024);
-            downloaded = true;
+            // 阻塞等待下载完成（可能直接命中磁盘缓存）
+            auto task = downloadManager->download(assetURL);
+            task->wait();
+            if (task->succeeded()) {
+                localAsset = std::make_unique<LargeModel>(task->getResultPath(), task->getTotalBytes());
+                downloaded = true;
+            }
         }
     }
     
 public:
-    NetworkAssetProxy(const std::string& url) 
-        : assetURL(url), downloaded(false) {}
+    NetworkAssetProxy(const std::string& url, AssetDownloadManager* manager = nullptr,
+                      AssetLoader* assetLoader = nullptr) 
+        : assetURL(url), downloaded(false),
+          downloadManager(manager ? manager : &AssetDownloadManager::getInstance()),
+          loader(assetLoader ? assetLoader : &AssetLoader::getInstance()) {}
+    
+    ~NetworkAssetProxy() {
+        if (pendingLoad) {
+            pendingLoad->cancelled.store(true, std::memory_order_relaxed);
+        }
+    }
     
     void load() override {
         downloadAsset();
@@ -228,6 +1485,50 @@ public:
         }
     }
     
+    // 异步下载并映射，完成后在渲染线程换上
+    void requestLoad(AssetLoadPriority priority = AssetLoadPriority::Normal,
+                     ReadyCallback onReady = nullptr) override {
+        (void)priority;
+        if (isLoaded()) {
+            if (onReady) {
+                onReady(this);
+            }
+            return;
+        }
+        if (onReady) {
+            readyCallbacks.push_back(std::move(onReady));
+        }
+        if (pendingLoad) {
+            return;
+        }
+        auto ticket = std::make_shared<LoadTicket>();
+        pendingLoad = ticket;
+        AssetLoader* completionLoader = loader;
+        downloadTask = downloadManager->download(assetURL,
+            [ticket, completionLoader, this](const AssetDownloadTask& task) {
+                if (task.succeeded() && !ticket->cancelled.load(std::memory_order_relaxed)) {
+                    auto model = std::make_unique<LargeModel>(task.getResultPath(), task.getTotalBytes());
+                    model->load();   // 只建立映射，开销很小
+                    ticket->result = std::move(model);
+                }
+                completionLoader->postCompletion([ticket, this] {
+                    if (ticket->cancelled.load(std::memory_order_relaxed)) {
+                        return;
+                    }
+                    pendingLoad.reset();
+                    if (ticket->result && !isLoaded()) {
+                        localAsset = std::move(ticket->result);
+                        downloaded = true;
+                    }
+                    auto callbacks = std::move(readyCallbacks);
+                    readyCallbacks.clear();
+                    for (auto& callback : callbacks) {
+                        callback(this);
+                    }
+                });
+            });
+    }
+    
     void render() override {
         if (!downloaded) {
             // 显示加载中的占位符
@@ -243,6 +1544,14 @@ public:
         return downloaded && localAsset && localAsset->isLoaded();
     }
     
+    // 下载进度0~1，未开始时为0
+    float getDownloadProgress() const {
+        if (isLoaded()) {
+            return 1.0f;
+        }
+        return downloadTask ? downloadTask->getProgress() : 0.0f;
+    }
+    
     size_t getSize() const override {
         return localAsset ? localAsset->getSize() : 0;
     }
@@ -282,12 +1591,26 @@ public:
         }
     }
     
-    // 渲染所有已加载的资源
+    // 异步预加载所有资源，不阻塞调用线程；配合update()使用
+    void preloadAllAsync(AssetLoadPriority priority = AssetLoadPriority::Normal) {
+        for (auto& asset : assets) {
+            asset->requestLoad(priority);
+        }
+    }
+    
+    // 每帧在渲染线程调用，把加载完成的资源换上
+    void update() {
+        AssetLoader::getInstance().pumpCompletions();
+    }
+    
+    size_t getPendingLoadCount() const {
+        return AssetLoader::getInstance().getPendingCount();
+    }
+    
+    // 渲染所有资源，未就绪的由各自的代理渲染占位符
     void renderAll() {
         for (auto& asset : assets) {
-            if (asset->isLoaded()) {
-                asset->render();
-            }
+            asset->render();
         }
     }
     
@@ -341,17 +1664,22 @@ public:
     
     void loadLevel() {
         if (!assetsLoaded) {
-            // 通过代理按需加载资源，而不是一次性加载所有
-            assetManager.preloadAll();
+            // 通过代理异步加载资源，不阻塞当前帧
+            assetManager.preloadAllAsync();
             assetsLoaded = true;
         }
     }
     
     void render() {
-        // 代理会确保资源在渲染时是可用的
+        // 先换上已加载完成的资源，未就绪的由代理渲染占位符
+        assetManager.update();
         assetManager.renderAll();
     }
     
+    bool isLevelReady() const {
+        return assetsLoaded && assetManager.getPendingLoadCount() == 0;
+    }
+    
     void showAssetInfo() {
         assetManager.printStats();
     }
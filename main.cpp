@@ -268,6 +268,9 @@ void demonstrateGameLoop() {
             std::cout << "玩家获得经验，等级: " << player->getLevel() << std::endl;
         }
         
+        // 帧末合并发送玩家状态变化通知
+        gameSession.endFrame();
+        
         // 更新游戏引擎
         engine.updateGame(0.016f);
         
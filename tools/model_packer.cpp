@@ -0,0 +1,15 @@
+#include "structural/proxy.h"
+#include <cstdio>
+
+// 离线模型打包工具：model_packer input.obj output.pmdl
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::fprintf(stderr, "用法: %s <input.obj> <output.pmdl>\n", argv[0]);
+        return 1;
+    }
+    if (!PackedModelConverter::convertObj(argv[1], argv[2])) {
+        std::fprintf(stderr, "转换失败: %s\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}